@@ -0,0 +1,657 @@
+////////////////////////////////////////////////////////////////////////////////
+// batched_io.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "batched_io.hpp"
+
+#include "config.hpp"
+#include "impl_finder.hpp"
+#include "utility.hpp"
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <target_selector/target_selector.hpp>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#if defined(__linux__) && defined(SYCL_INFO_HAVE_IO_URING)
+#define SYCL_INFO_USE_IO_URING
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <initializer_list>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+#endif
+
+namespace sycl_info {
+
+/// \brief The number of threads the blocking requests are spread over. The
+/// threads mostly wait for the filesystem, so there are more than cores.
+///
+constexpr std::size_t io_threads = 16;
+
+/// \brief How long a directory that cannot be opened is remembered for
+///
+constexpr std::chrono::seconds missing_directory_lifetime{10};
+
+namespace {
+class missing_directories {
+ public:
+  bool contains(const std::string& path) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    const auto it = expiries_.find(path);
+    if (it == expiries_.end()) {
+      return false;
+    }
+    if (it->second <= std::chrono::steady_clock::now()) {
+      expiries_.erase(it);
+      return false;
+    }
+    return true;
+  }
+
+  void insert(const std::string& path) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    expiries_[path] =
+        std::chrono::steady_clock::now() + missing_directory_lifetime;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<std::string, std::chrono::steady_clock::time_point>
+      expiries_;
+};
+
+missing_directories& known_missing_directories() {
+  static missing_directories directories;
+  return directories;
+}
+}  // namespace
+
+std::vector<std::vector<std::string>> search_directories(
+    const std::vector<std::string>& paths, const search_options& options) {
+  auto files = std::vector<std::vector<std::string>>(paths.size());
+  auto& missing = known_missing_directories();
+  parallel_for(
+      paths.size(),
+      [&](std::size_t i) {
+        try {
+          if (!missing.contains(paths[i]) &&
+              !find_syclinfo_files(paths[i], options, files[i])) {
+            missing.insert(paths[i]);
+          }
+        } catch (std::exception&) {
+          files[i].clear();
+        }
+      },
+      io_threads);
+  return files;
+}
+
+#ifdef _WIN32
+bool get_file_identity(const std::string& path, file_identity& identity) {
+  auto customDeleter = [](HANDLE ptr) { CloseHandle(ptr); };
+  auto handle = std::unique_ptr<std::remove_pointer<HANDLE>::type,
+                                decltype(customDeleter)>(
+      CreateFileA(path.c_str(), 0,
+                  FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                  nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr),
+      customDeleter);
+  BY_HANDLE_FILE_INFORMATION info;
+  if (handle.get() == INVALID_HANDLE_VALUE ||
+      !GetFileInformationByHandle(handle.get(), &info)) {
+    return false;
+  }
+  identity = file_identity{
+      info.dwVolumeSerialNumber,
+      (static_cast<std::uint64_t>(info.nFileIndexHigh) << 32) |
+          info.nFileIndexLow};
+  return true;
+}
+#else
+bool get_file_identity(const std::string& path, file_identity& identity) {
+  struct stat info;
+  if (stat(path.c_str(), &info) != 0) {
+    return false;
+  }
+  identity = file_identity{static_cast<std::uint64_t>(info.st_dev),
+                           static_cast<std::uint64_t>(info.st_ino)};
+  return true;
+}
+#endif
+
+/// \brief Reads a file with blocking requests
+///
+static void read_file(batched_file& file) {
+  file.read = false;
+  file.contents.clear();
+  file.identified = get_file_identity(file.path, file.identity);
+  std::ifstream in{file.path, std::ios::binary};
+  if (!in) {
+    return;
+  }
+  constexpr std::size_t chunk = 16384;
+  char buffer[chunk];
+  while (in.read(buffer, chunk) || in.gcount() > 0) {
+    file.contents.append(buffer, static_cast<std::size_t>(in.gcount()));
+  }
+  file.read = !in.bad();
+}
+
+/// \brief Reads the files at the given indices on a pool of threads
+///
+static void read_files_with_threads(std::vector<batched_file>& files,
+                                    const std::vector<std::size_t>& indices) {
+  parallel_for(
+      indices.size(),
+      [&](std::size_t i) {
+        auto& file = files[indices[i]];
+        try {
+          read_file(file);
+        } catch (std::exception&) {
+          file.read = false;
+        }
+      },
+      io_threads);
+}
+
+#ifdef _WIN32
+/// \brief Queries a file with a blocking request
+///
+static void stat_file(const std::string& path, file_stamp& stamp) {
+  WIN32_FILE_ATTRIBUTE_DATA data;
+  stamp.found = GetFileAttributesExA(path.c_str(), GetFileExInfoStandard,
+                                     &data) != 0 &&
+                get_file_identity(path, stamp.identity);
+  if (stamp.found) {
+    stamp.size = (static_cast<std::uint64_t>(data.nFileSizeHigh) << 32) |
+                 data.nFileSizeLow;
+    // FILETIME counts 100 ns intervals; only differences matter here
+    stamp.modified = static_cast<std::int64_t>(
+        ((static_cast<std::uint64_t>(data.ftLastWriteTime.dwHighDateTime)
+          << 32) |
+         data.ftLastWriteTime.dwLowDateTime) *
+        100);
+  }
+}
+#else
+/// \brief Queries a file with a blocking request
+///
+static void stat_file(const std::string& path, file_stamp& stamp) {
+  struct stat info;
+  stamp.found = stat(path.c_str(), &info) == 0;
+  if (stamp.found) {
+    stamp.identity = file_identity{static_cast<std::uint64_t>(info.st_dev),
+                                   static_cast<std::uint64_t>(info.st_ino)};
+    stamp.size = static_cast<std::uint64_t>(info.st_size);
+    stamp.modified = static_cast<std::int64_t>(info.st_mtim.tv_sec) *
+                         1000000000 +
+                     info.st_mtim.tv_nsec;
+  }
+}
+#endif
+
+#ifdef SYCL_INFO_USE_IO_URING
+namespace {
+/// \brief A minimal io_uring: one submission queue filled and drained by a
+/// single thread
+///
+class io_ring {
+ public:
+  explicit io_ring(unsigned entries) {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (fd_ < 0) {
+      return;
+    }
+
+    sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const auto singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMap) {
+      sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+    }
+    sqRing_ = map(sqRingSize_, IORING_OFF_SQ_RING);
+    cqRing_ = singleMap ? sqRing_ : map(cqRingSize_, IORING_OFF_CQ_RING);
+    sqesSize_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe*>(map(sqesSize_, IORING_OFF_SQES));
+    if (!sqRing_ || !cqRing_ || !sqes_) {
+      release();
+      return;
+    }
+
+    auto* sq = static_cast<char*>(sqRing_);
+    sqTail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sqMask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sqArray_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    auto* cq = static_cast<char*>(cqRing_);
+    cqHead_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cqTail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cqMask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    entries_ = params.sq_entries;
+    tail_ = *sqTail_;
+  }
+
+  ~io_ring() { release(); }
+
+  io_ring(const io_ring&) = delete;
+  io_ring& operator=(const io_ring&) = delete;
+
+  bool valid() const noexcept { return fd_ >= 0; }
+
+  /// \brief The number of requests that can be queued before submit()
+  unsigned entries() const noexcept { return entries_; }
+
+  /// \brief Checks that the kernel implements every given operation
+  bool supports(std::initializer_list<int> operations) const {
+    constexpr unsigned probedOperations = 256;
+    // io_uring_probe is followed by its array of io_uring_probe_op
+    auto buffer = std::vector<std::uint64_t>(
+        (sizeof(io_uring_probe) +
+         probedOperations * sizeof(io_uring_probe_op)) /
+        sizeof(std::uint64_t));
+    auto* probe = reinterpret_cast<io_uring_probe*>(buffer.data());
+    if (syscall(__NR_io_uring_register, fd_, IORING_REGISTER_PROBE, probe,
+                probedOperations) < 0) {
+      return false;
+    }
+    for (const auto operation : operations) {
+      if (operation > probe->last_op ||
+          !(probe->ops[operation].flags & IO_URING_OP_SUPPORTED)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /// \brief Queues a zeroed request; at most entries() can be queued
+  io_uring_sqe& queue(std::uint64_t userData) {
+    const auto index = tail_ & sqMask_;
+    auto& sqe = sqes_[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.user_data = userData;
+    sqArray_[index] = index;
+    ++tail_;
+    ++queued_;
+    return sqe;
+  }
+
+  /// \brief Submits the queued requests and calls complete(cqe) for each of
+  /// their completions, as they arrive
+  /// \returns false if the kernel rejected the requests
+  template <class Complete>
+  bool submit(Complete complete) {
+    __atomic_store_n(sqTail_, tail_, __ATOMIC_RELEASE);
+    auto pending = queued_;
+    while (pending > 0) {
+      const auto submitted = syscall(__NR_io_uring_enter, fd_, queued_, 1u,
+                                     IORING_ENTER_GETEVENTS, nullptr, 0);
+      if (submitted < 0) {
+        if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+          continue;
+        }
+        return false;
+      }
+      queued_ -= static_cast<unsigned>(submitted);
+
+      auto head = *cqHead_;
+      const auto tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+      for (; head != tail; ++head, --pending) {
+        complete(cqes_[head & cqMask_]);
+      }
+      __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+    }
+    return true;
+  }
+
+ private:
+  void* map(std::size_t size, off_t offset) const {
+    auto* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, fd_, offset);
+    return ptr == MAP_FAILED ? nullptr : ptr;
+  }
+
+  void release() noexcept {
+    if (sqes_) {
+      munmap(sqes_, sqesSize_);
+    }
+    if (cqRing_ && cqRing_ != sqRing_) {
+      munmap(cqRing_, cqRingSize_);
+    }
+    if (sqRing_) {
+      munmap(sqRing_, sqRingSize_);
+    }
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+    sqes_ = nullptr;
+    cqRing_ = sqRing_ = nullptr;
+    fd_ = -1;
+  }
+
+  int fd_ = -1;
+  void* sqRing_ = nullptr;
+  void* cqRing_ = nullptr;
+  io_uring_sqe* sqes_ = nullptr;
+  std::size_t sqRingSize_ = 0;
+  std::size_t cqRingSize_ = 0;
+  std::size_t sqesSize_ = 0;
+  unsigned* sqTail_ = nullptr;
+  unsigned sqMask_ = 0;
+  unsigned* sqArray_ = nullptr;
+  unsigned* cqHead_ = nullptr;
+  unsigned* cqTail_ = nullptr;
+  unsigned cqMask_ = 0;
+  io_uring_cqe* cqes_ = nullptr;
+  unsigned entries_ = 0;
+  unsigned tail_ = 0;
+  unsigned queued_ = 0;
+};
+
+/// \brief The state of a file of a group while it is read
+///
+struct ring_file {
+  int fd = -1;
+  bool queried = false;
+  bool done = false;
+  std::size_t size = 0;
+  struct statx info;
+};
+}  // namespace
+
+/// \brief Reads files [first, last) as three rounds of requests: the files
+/// are opened and queried together, then read together, then closed. Short
+/// reads are resumed in further rounds.
+/// \returns false if the ring failed, in which case no file was read. The
+/// files that were opened but whose size could not be queried are not read
+/// either: their indices are added to unsized.
+///
+static bool read_group_with_ring(io_ring& ring,
+                                 std::vector<batched_file>& files,
+                                 std::size_t first, std::size_t last,
+                                 std::vector<std::size_t>& unsized) {
+  auto state = std::vector<ring_file>(last - first);
+  auto closeAll = [&state]() {
+    for (auto& file : state) {
+      if (file.fd >= 0) {
+        close(file.fd);
+      }
+    }
+  };
+
+  for (std::size_t i = 0; i < state.size(); ++i) {
+    const auto path = reinterpret_cast<std::uintptr_t>(
+        files[first + i].path.c_str());
+    auto& open = ring.queue(i << 1);
+    open.opcode = IORING_OP_OPENAT;
+    open.fd = AT_FDCWD;
+    open.addr = path;
+    open.open_flags = O_RDONLY | O_CLOEXEC;
+
+    auto& query = ring.queue((i << 1) | 1);
+    query.opcode = IORING_OP_STATX;
+    query.fd = AT_FDCWD;
+    query.addr = path;
+    query.len = STATX_SIZE | STATX_INO;
+    query.off = reinterpret_cast<std::uintptr_t>(&state[i].info);
+  }
+  const auto opened = ring.submit([&state](const io_uring_cqe& cqe) {
+    auto& file = state[cqe.user_data >> 1];
+    if (cqe.user_data & 1) {
+      file.queried = cqe.res == 0;
+    } else {
+      file.fd = cqe.res;
+    }
+  });
+  if (!opened) {
+    closeAll();
+    return false;
+  }
+
+  auto unqueried = std::vector<std::size_t>{};
+  for (std::size_t i = 0; i < state.size(); ++i) {
+    auto& file = state[i];
+    auto& result = files[first + i];
+    if (file.queried) {
+      result.identified = true;
+      result.identity = file_identity{
+          makedev(file.info.stx_dev_major, file.info.stx_dev_minor),
+          file.info.stx_ino};
+      result.contents.resize(file.info.stx_size);
+    }
+    // Without its size, an opened file cannot be read through the ring: it
+    // is left to read_file()
+    if (file.fd >= 0 && !file.queried) {
+      unqueried.push_back(first + i);
+    }
+    file.done = file.fd < 0 || !file.queried || result.contents.empty();
+    result.read = file.fd >= 0 && file.queried;
+  }
+
+  for (auto reading = true; reading;) {
+    reading = false;
+    for (std::size_t i = 0; i < state.size(); ++i) {
+      auto& file = state[i];
+      if (file.done) {
+        continue;
+      }
+      auto& contents = files[first + i].contents;
+      auto& read = ring.queue(i);
+      read.opcode = IORING_OP_READ;
+      read.fd = file.fd;
+      read.addr = reinterpret_cast<std::uintptr_t>(&contents[file.size]);
+      read.len = static_cast<std::uint32_t>(contents.size() - file.size);
+      read.off = file.size;
+      reading = true;
+    }
+    const auto submitted = ring.submit([&](const io_uring_cqe& cqe) {
+      auto& file = state[cqe.user_data];
+      auto& result = files[first + cqe.user_data];
+      if (cqe.res < 0) {
+        result.read = false;
+        file.done = true;
+      } else if (cqe.res == 0) {
+        // The file was truncated since it was queried
+        result.contents.resize(file.size);
+        file.done = true;
+      } else {
+        file.size += static_cast<std::size_t>(cqe.res);
+        file.done = file.size == result.contents.size();
+      }
+    });
+    if (!submitted) {
+      closeAll();
+      return false;
+    }
+  }
+  closeAll();
+
+  for (std::size_t i = first; i < last; ++i) {
+    if (!files[i].read) {
+      files[i].contents.clear();
+    }
+  }
+  // Only once the group is done, as a group whose ring fails is read again
+  // as a whole
+  unsized.insert(unsized.end(), unqueried.begin(), unqueried.end());
+  return true;
+}
+
+/// \brief Queries files [first, last) as one round of requests
+/// \returns false if the ring failed
+///
+static bool stat_group_with_ring(io_ring& ring,
+                                 const std::vector<std::string>& paths,
+                                 std::vector<file_stamp>& stamps,
+                                 std::size_t first, std::size_t last) {
+  auto info = std::vector<struct statx>(last - first);
+  for (std::size_t i = 0; i < info.size(); ++i) {
+    auto& query = ring.queue(i);
+    query.opcode = IORING_OP_STATX;
+    query.fd = AT_FDCWD;
+    query.addr = reinterpret_cast<std::uintptr_t>(paths[first + i].c_str());
+    query.len = STATX_SIZE | STATX_INO | STATX_MTIME;
+    query.off = reinterpret_cast<std::uintptr_t>(&info[i]);
+  }
+  return ring.submit([&](const io_uring_cqe& cqe) {
+    const auto& queried = info[cqe.user_data];
+    auto& stamp = stamps[first + cqe.user_data];
+    stamp.found = cqe.res == 0;
+    if (stamp.found) {
+      stamp.identity = file_identity{
+          makedev(queried.stx_dev_major, queried.stx_dev_minor),
+          queried.stx_ino};
+      stamp.size = queried.stx_size;
+      stamp.modified =
+          queried.stx_mtime.tv_sec * 1000000000 + queried.stx_mtime.tv_nsec;
+    }
+  });
+}
+
+/// \brief Queries files [first, paths.size()) through an io_uring
+/// \returns the first file that could not be queried through the ring
+///
+static std::size_t stat_files_with_ring(const std::vector<std::string>& paths,
+                                        std::vector<file_stamp>& stamps,
+                                        std::size_t first) {
+  constexpr unsigned ringEntries = 256;
+  io_ring ring{ringEntries};
+  if (!ring.valid() || !ring.supports({IORING_OP_STATX})) {
+    return first;
+  }
+  while (first < paths.size()) {
+    const auto last =
+        std::min<std::size_t>(paths.size(), first + ring.entries());
+    if (!stat_group_with_ring(ring, paths, stamps, first, last)) {
+      break;
+    }
+    first = last;
+  }
+  return first;
+}
+
+/// \brief Reads files [first, files.size()) through an io_uring
+/// \returns the first file that could not be read through the ring, as the
+/// ring cannot be used on this kernel or failed. The files before it that
+/// could not be read through the ring either are added to unsized.
+///
+static std::size_t read_files_with_ring(std::vector<batched_file>& files,
+                                        std::size_t first,
+                                        std::vector<std::size_t>& unsized) {
+  constexpr unsigned ringEntries = 256;
+  io_ring ring{ringEntries};
+  if (!ring.valid() ||
+      !ring.supports({IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ})) {
+    return first;
+  }
+  // Each file takes two requests in the first round
+  const auto group = std::size_t{ring.entries() / 2};
+  while (first < files.size()) {
+    const auto last = std::min(files.size(), first + group);
+    if (!read_group_with_ring(ring, files, first, last, unsized)) {
+      break;
+    }
+    first = last;
+  }
+  return first;
+}
+#endif  // SYCL_INFO_USE_IO_URING
+
+io_backend batched_io_backend() {
+#ifdef SYCL_INFO_USE_IO_URING
+  if (target_selector::getenv_variable("SYCL_INFO_IO") !=
+      to_string(io_backend::thread_pool)) {
+    return io_backend::io_uring;
+  }
+#endif
+  return io_backend::thread_pool;
+}
+
+const char* to_string(const io_backend backend) noexcept {
+  return backend == io_backend::io_uring ? "io_uring" : "threads";
+}
+
+std::vector<batched_file> read_files(const std::vector<std::string>& paths) {
+  target_selector::scoped_timer timer{"read .syclinfo"};
+  auto files = std::vector<batched_file>(paths.size());
+  for (std::size_t i = 0; i < paths.size(); ++i) {
+    files[i].path = paths[i];
+  }
+
+  auto first = std::size_t{0};
+  // The files left to the thread pool
+  auto unread = std::vector<std::size_t>{};
+#ifdef SYCL_INFO_USE_IO_URING
+  if (batched_io_backend() == io_backend::io_uring) {
+    first = read_files_with_ring(files, first, unread);
+  }
+#endif
+  for (auto i = first; i < files.size(); ++i) {
+    unread.push_back(i);
+  }
+  if (!unread.empty()) {
+    read_files_with_threads(files, unread);
+  }
+  return files;
+}
+
+std::vector<file_stamp> stat_files(const std::vector<std::string>& paths) {
+  target_selector::scoped_timer timer{"stat .syclinfo"};
+  auto stamps = std::vector<file_stamp>(paths.size());
+  auto first = std::size_t{0};
+#ifdef SYCL_INFO_USE_IO_URING
+  if (batched_io_backend() == io_backend::io_uring) {
+    first = stat_files_with_ring(paths, stamps, first);
+  }
+#endif
+  parallel_for(
+      paths.size() - first,
+      [&](std::size_t i) { stat_file(paths[first + i], stamps[first + i]); },
+      io_threads);
+  return stamps;
+}
+
+void update_stamps(fnv1a_hash& hash, const std::vector<std::string>& files) {
+  const auto stamps = stat_files(files);
+  for (std::size_t i = 0; i < files.size(); ++i) {
+    hash.update(files[i]);
+    if (stamps[i].found) {
+      hash.update(std::to_string(stamps[i].identity.first));
+      hash.update(std::to_string(stamps[i].identity.second));
+      hash.update(std::to_string(stamps[i].size));
+      hash.update(std::to_string(stamps[i].modified));
+    }
+  }
+}
+
+}  // namespace sycl_info
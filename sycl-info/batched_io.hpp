@@ -0,0 +1,120 @@
+////////////////////////////////////////////////////////////////////////////////
+// batched_io.hpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SYCL_INFO_BATCHED_IO_HPP
+#define SYCL_INFO_BATCHED_IO_HPP
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sycl_info {
+
+class fnv1a_hash;
+struct search_options;
+
+/// \brief Identifies a file independently of the path it is reached through
+/// (e.g. a symlinked directory): its device and inode, or its volume serial
+/// number and file index on Windows
+///
+using file_identity = std::pair<std::uint64_t, std::uint64_t>;
+
+/// \brief Retrieves the identity of the file a path leads to
+/// \returns false if the file cannot be queried
+///
+bool get_file_identity(const std::string& path, file_identity& identity);
+
+/// \brief How the file I/O of a batch is carried out
+///
+enum class io_backend {
+  /// \brief The files are opened, queried and read by asynchronous requests
+  /// submitted to an io_uring together (Linux 5.6 and later)
+  io_uring,
+  /// \brief The files are read concurrently by a pool of threads
+  thread_pool,
+};
+
+/// \brief The backend used by read_files(). io_uring is used when the build
+/// and the kernel support it, unless the environment variable SYCL_INFO_IO is
+/// set to "threads".
+///
+io_backend batched_io_backend();
+
+/// \brief The name of a backend, as accepted by SYCL_INFO_IO
+///
+const char* to_string(io_backend backend) noexcept;
+
+/// \brief A file read as part of a batch
+///
+struct batched_file {
+  std::string path;
+  /// \brief false if the file could not be opened or read
+  bool read = false;
+  /// \brief false if the identity of the file could not be queried
+  bool identified = false;
+  file_identity identity;
+  std::string contents;
+};
+
+/// \brief Searches several directories for .syclinfo files concurrently, so
+/// that the round trips to a network filesystem overlap (see
+/// find_syclinfo_files()).
+///
+/// A directory that cannot be opened is remembered for a few seconds and is
+/// not looked up again in the meantime: a vendor path that does not exist is
+/// usually searched by each lookup of a run.
+/// \returns the paths of the files of each directory, in the order of the
+/// directories
+///
+std::vector<std::vector<std::string>> search_directories(
+    const std::vector<std::string>& paths, const search_options& options);
+
+/// \brief Opens, queries the identity of and reads every file of a list as
+/// a batch, so that the latency of a network filesystem is paid once per
+/// batch rather than once per request
+/// \returns one entry per path, in the same order
+///
+std::vector<batched_file> read_files(const std::vector<std::string>& paths);
+
+/// \brief What identifies the version of a file without reading it
+///
+struct file_stamp {
+  /// \brief false if the file could not be queried
+  bool found = false;
+  file_identity identity;
+  std::uint64_t size = 0;
+  /// \brief The last modification time, in nanoseconds since the epoch
+  std::int64_t modified = 0;
+};
+
+/// \brief Queries the stamp of every file of a list as a batch, like
+/// read_files()
+/// \returns one entry per path, in the same order
+///
+std::vector<file_stamp> stat_files(const std::vector<std::string>& paths);
+
+/// \brief Adds the paths and the stamps (see stat_files()) of a list of files
+/// to a hash, so that the hash changes when one of them does
+///
+void update_stamps(fnv1a_hash& hash, const std::vector<std::string>& files);
+
+}  // namespace sycl_info
+
+#endif  // SYCL_INFO_BATCHED_IO_HPP
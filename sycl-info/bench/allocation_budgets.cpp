@@ -0,0 +1,150 @@
+////////////////////////////////////////////////////////////////////////////////
+// allocation_budgets.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "allocation_counter.hpp"
+#include "bench_harness.hpp"
+#include "catalog_generator.hpp"
+#include "impl_finder.hpp"
+#include "impl_matchers.hpp"
+#include <cstddef>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <target_selector/target_selector.hpp>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Checks the heap allocations of the hot paths against a budget, so that an
+// added allocation fails the allocations test instead of going unnoticed.
+// Each budget is the count of libstdc++ plus some headroom (see limit()), so
+// that other standard libraries, which allocate a little differently, pass
+// too. When an allocation is removed, lower the count to keep the gain.
+
+namespace {
+struct allocation_budget {
+  std::string path;
+  /// @brief The allocations one call performs with libstdc++
+  std::size_t counted;
+  std::function<std::size_t()> function;
+
+  /// @brief The most allocations one call may perform: a quarter more than
+  /// counted, and at least two more
+  ///
+  std::size_t limit() const noexcept { return counted + counted / 4 + 2; }
+};
+
+/// @brief Runs the function once so that lazily initialized state is not
+/// counted, then counts the allocations of a second call
+///
+sycl_info::bench::allocation_stats count_allocations(
+    const std::function<std::size_t()>& function) {
+  sycl_info::bench::keep(function());
+  const auto scope = sycl_info::bench::allocation_scope{};
+  sycl_info::bench::keep(function());
+  return scope.stats();
+}
+}  // namespace
+
+int main() {
+  using sycl_info::using_target_matcher;
+  using configs =
+      sycl_info::select<sycl_info::selections::supported_configurations>;
+  using plat_name = sycl_info::select<sycl_info::selections::plat_name>;
+  using dev_name = sycl_info::select<sycl_info::selections::dev_name>;
+
+  const auto spec = sycl_info::bench::catalog_spec{1, 8, 2, 32, 1};
+  const auto impl = sycl_info::bench::generate_impl(spec, 0);
+  const auto hardware = sycl_info::bench::generate_hardware(spec);
+  const auto& conf = impl[configs::value][0];
+  const auto picked =
+      sycl_info::config{conf[plat_name::value], conf[dev_name::value]};
+  const auto list = std::string{"first,second,third,fourth"};
+  const auto directory = std::string{"/opt/sycl/share/sycl-info/vendors"};
+  const auto file = std::string{"implementation.syclinfo"};
+
+  auto budgets = std::vector<allocation_budget>{
+      {"split (4 fields)", 3,
+       [&list]() { return sycl_info::split(list, ',').size(); }},
+      {"concat_path", 2,
+       [&directory, &file]() {
+         return sycl_info::concat_path(directory, sycl_info::path_separator,
+                                       file)
+             .size();
+       }},
+      {"from_json (8 configurations)", 61,
+       [&impl]() { return using_target_matcher::from_json(impl).size(); }},
+      {"match (8 configurations)", 108,
+       [&impl, &hardware]() {
+         return using_target_matcher::match(impl, hardware).size();
+       }},
+      {"match_config_with_impls (1 configuration)", 14,
+       [&impl, &picked]() {
+         return sycl_info::match_config_with_impls(picked, impl, "")
+             .deviceFlags.size();
+       }},
+  };
+
+  // The OpenCL paths need an ICD, which the allocations test provides with
+  // the stub ICD. Without one they would go unchecked, so that fails.
+  auto devices = std::vector<std::pair<cl_platform_id, cl_device_id>>{};
+  try {
+    auto usedVendorAsType = true;
+    target_selector::find_devices(
+        devices, "*", "*", usedVendorAsType,
+        std::unordered_map<std::string, std::string>{}, true);
+  } catch (std::exception& e) {
+    std::cerr << "Cannot check the OpenCL paths: " << e.what() << '\n';
+    return 1;
+  }
+  if (devices.empty()) {
+    std::cerr << "Cannot check the OpenCL paths: no OpenCL device found; run "
+                 "the allocations test, which uses the stub ICD\n";
+    return 1;
+  }
+  const auto device = devices.front().second;
+  budgets.push_back(allocation_budget{
+      "get_info_from_opencl (CL_DEVICE_NAME)", 3, [device]() {
+        return target_selector::get_info_from_opencl(device, CL_DEVICE_NAME,
+                                                     clGetDeviceInfo)
+            .size();
+      }});
+  // 452 for the 32 devices of the stub ICD, so that the budget follows the
+  // number of devices of other ICDs
+  budgets.push_back(allocation_budget{
+      "to_print_type (" + std::to_string(devices.size()) + " devices)",
+      (452 * devices.size() + 31) / 32,
+      [&devices]() { return sycl_info::to_print_type(devices).size(); }});
+
+  auto overBudget = 0;
+  std::cout << std::left << std::setw(48) << "Path" << std::right
+            << std::setw(12) << "Allocations" << std::setw(12) << "Budget"
+            << std::setw(12) << "Bytes" << '\n';
+  for (const auto& budget : budgets) {
+    const auto stats = count_allocations(budget.function);
+    const auto over = stats.allocations > budget.limit();
+    overBudget += over ? 1 : 0;
+    std::cout << std::left << std::setw(48) << budget.path << std::right
+              << std::setw(12) << stats.allocations << std::setw(12)
+              << budget.limit() << std::setw(12) << stats.bytes
+              << (over ? "  OVER BUDGET" : "") << '\n';
+  }
+  return overBudget == 0 ? 0 : 1;
+}
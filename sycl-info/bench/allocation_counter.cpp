@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////////
+// allocation_counter.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "allocation_counter.hpp"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+// Trivially constructed, so it is usable from the first allocation of a
+// thread on
+thread_local sycl_info::bench::allocation_stats threadStats;
+
+void* counted_allocation(std::size_t size) noexcept {
+  ++threadStats.allocations;
+  threadStats.bytes += size;
+  return std::malloc(size != 0 ? size : 1);
+}
+
+void* counted_allocation_or_throw(std::size_t size) {
+  auto* memory = counted_allocation(size);
+  if (!memory) {
+    throw std::bad_alloc{};
+  }
+  return memory;
+}
+}  // namespace
+
+namespace sycl_info {
+namespace bench {
+
+allocation_stats thread_allocations() noexcept { return threadStats; }
+
+}  // namespace bench
+}  // namespace sycl_info
+
+void* operator new(std::size_t size) {
+  return counted_allocation_or_throw(size);
+}
+
+void* operator new[](std::size_t size) {
+  return counted_allocation_or_throw(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  return counted_allocation(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return counted_allocation(size);
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+
+void operator delete[](void* memory) noexcept { std::free(memory); }
+
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+
+void operator delete[](void* memory, std::size_t) noexcept {
+  std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+  std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+  std::free(memory);
+}
@@ -0,0 +1,65 @@
+////////////////////////////////////////////////////////////////////////////////
+// allocation_counter.hpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SYCL_INFO_BENCH_ALLOCATION_COUNTER_HPP
+#define SYCL_INFO_BENCH_ALLOCATION_COUNTER_HPP
+
+#include <cstddef>
+
+// Linking allocation_counter.cpp replaces the global operator new/delete
+// with ones that count the allocations of each thread, so it is only linked
+// into test executables.
+
+namespace sycl_info {
+namespace bench {
+
+/// @brief The heap allocations made by a thread
+///
+struct allocation_stats {
+  std::size_t allocations;
+  std::size_t bytes;
+};
+
+/// @brief The allocations made by the calling thread since it started
+///
+allocation_stats thread_allocations() noexcept;
+
+/// @brief Records the allocations made by the calling thread from its
+/// construction on. Scopes can be nested.
+///
+class allocation_scope {
+ public:
+  allocation_scope() noexcept : start_{thread_allocations()} {}
+
+  /// @brief The allocations made since the scope was constructed
+  ///
+  allocation_stats stats() const noexcept {
+    const auto now = thread_allocations();
+    return allocation_stats{now.allocations - start_.allocations,
+                            now.bytes - start_.bytes};
+  }
+
+ private:
+  allocation_stats start_;
+};
+
+}  // namespace bench
+}  // namespace sycl_info
+
+#endif  // SYCL_INFO_BENCH_ALLOCATION_COUNTER_HPP
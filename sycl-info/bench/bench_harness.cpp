@@ -0,0 +1,245 @@
+////////////////////////////////////////////////////////////////////////////////
+// bench_harness.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "bench_harness.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <target_selector/target_selector.hpp>
+
+namespace sycl_info {
+namespace bench {
+
+/// @brief The value below which the given fraction of the sorted samples
+/// lie, using the nearest rank
+///
+static double percentile(const std::vector<double>& sorted, double fraction) {
+  const auto rank = static_cast<std::size_t>(
+      std::ceil(fraction * static_cast<double>(sorted.size())));
+  return sorted[std::min(std::max(rank, std::size_t{1}), sorted.size()) - 1];
+}
+
+bench_result summarize(const std::string& name, std::vector<double> samples,
+                       std::size_t items) {
+  auto result = bench_result{name, samples.size(), items, 0, 0, 0, 0, 0};
+  if (samples.empty()) {
+    return result;
+  }
+  std::sort(samples.begin(), samples.end());
+  result.min = samples.front();
+  result.max = samples.back();
+  result.mean = std::accumulate(samples.begin(), samples.end(), 0.0) /
+                static_cast<double>(samples.size());
+  const auto middle = samples.size() / 2;
+  result.median = (samples.size() % 2 != 0)
+                      ? samples[middle]
+                      : (samples[middle - 1] + samples[middle]) / 2;
+  result.p95 = percentile(samples, 0.95);
+  return result;
+}
+
+void keep(std::size_t value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+  // An empty asm statement that takes the value as an input: the value has
+  // to be computed, but no instruction is emitted for it
+  asm volatile("" : : "r"(value) : "memory");
+#else
+  static volatile std::size_t sink;
+  sink = value;
+  static_cast<void>(sink);
+#endif
+}
+
+double calibrate() {
+  constexpr auto repetitions = 15;
+  constexpr auto strings = 2000;
+  auto fastest = std::numeric_limits<double>::max();
+  for (auto i = 0; i < repetitions; ++i) {
+    const auto start = std::chrono::steady_clock::now();
+    auto values = std::vector<std::string>{};
+    auto state = std::uint32_t{1};
+    for (auto n = 0; n < strings; ++n) {
+      // A linear congruential generator, so that every run sorts the same
+      state = state * 1664525u + 1013904223u;
+      values.push_back("calibration/" + std::to_string(state));
+    }
+    std::sort(values.begin(), values.end());
+    keep(values.front().size());
+    const auto end = std::chrono::steady_clock::now();
+    fastest = std::min(
+        fastest, std::chrono::duration<double, std::nano>(end - start).count());
+  }
+  return fastest;
+}
+
+nlohmann::json to_json(const bench_result& result) {
+  auto json = nlohmann::json::object();
+  json["name"] = result.name;
+  json["repetitions"] = result.repetitions;
+  json["items"] = result.items;
+  json["min_ns"] = result.min;
+  json["median_ns"] = result.median;
+  json["mean_ns"] = result.mean;
+  json["p95_ns"] = result.p95;
+  json["max_ns"] = result.max;
+  return json;
+}
+
+/// @brief Finds the element of a json array with the given name
+/// @return The element or nullptr
+///
+static const nlohmann::json* find_named(const nlohmann::json& array,
+                                        const nlohmann::json& name) {
+  for (const auto& element : array) {
+    if (element["name"] == name) {
+      return &element;
+    }
+  }
+  return nullptr;
+}
+
+/// @brief Checks that two cases were generated from the same spec
+///
+static bool same_spec(const nlohmann::json& lhs, const nlohmann::json& rhs) {
+  for (const auto* field : {"files", "configs_per_file", "backends_per_config",
+                            "name_length", "seed"}) {
+    if (lhs[field] != rhs[field]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// @brief The fastest repetition of a result, relative to its calibration if
+/// it has one
+///
+static double fastest_time(const nlohmann::json& result) {
+  const auto min = result["min_ns"].get<double>();
+  const auto calibration = result.find("calibration_ns");
+  return (calibration != result.end() && calibration->get<double>() > 0)
+             ? min / calibration->get<double>()
+             : min;
+}
+
+/// @brief How much slower, in percent, the median of a result is than its
+/// fastest repetition
+///
+static double jitter(const nlohmann::json& result) {
+  const auto min = result["min_ns"].get<double>();
+  return min > 0 ? 100.0 * (result["median_ns"].get<double>() - min) / min
+                 : 0.0;
+}
+
+std::size_t compare_with_baseline(const nlohmann::json& results,
+                                  const nlohmann::json& baseline,
+                                  double tolerance, std::ostream& report) {
+  auto regressions = std::size_t{0};
+  for (const auto& benchCase : results["cases"]) {
+    const auto* baseCase = find_named(baseline["cases"], benchCase["name"]);
+    if (!baseCase) {
+      report << benchCase["name"].get<std::string>()
+             << ": not in the baseline\n";
+      continue;
+    }
+    if (!same_spec(*baseCase, benchCase)) {
+      target_selector::target_selector_throw_error(
+          "The baseline of case " + benchCase["name"].get<std::string>() +
+          " was generated from a different spec");
+    }
+
+    for (const auto& result : benchCase["results"]) {
+      const auto name = benchCase["name"].get<std::string>() + '/' +
+                        result["name"].get<std::string>();
+      const auto* base = find_named((*baseCase)["results"], result["name"]);
+      if (!base) {
+        report << name << ": not in the baseline\n";
+        continue;
+      }
+      const auto allowed =
+          std::max(tolerance, std::max(jitter(result), jitter(*base)));
+      const auto current = fastest_time(result);
+      const auto expected = fastest_time(*base);
+      const auto regressed = current > expected * (1.0 + allowed / 100.0);
+      regressions += regressed ? 1 : 0;
+      const auto percent =
+          expected > 0 ? std::lround(100.0 * current / expected) : 0L;
+      report << name << " min_ns: " << result["min_ns"].get<double>()
+             << " vs " << (*base)["min_ns"].get<double>() << " ("
+             << percent << "% once calibrated, "
+             << std::lround(100.0 + allowed) << "% allowed)"
+             << (regressed ? " REGRESSION" : "") << '\n';
+    }
+  }
+  return regressions;
+}
+
+void keep_fastest(nlohmann::json& fastest, const nlohmann::json& results) {
+  for (auto& benchCase : fastest["cases"]) {
+    const auto* other = find_named(results["cases"], benchCase["name"]);
+    if (!other) {
+      continue;
+    }
+    for (auto& result : benchCase["results"]) {
+      const auto* rerun = find_named((*other)["results"], result["name"]);
+      if (rerun && fastest_time(*rerun) < fastest_time(result)) {
+        result = *rerun;
+      }
+    }
+  }
+}
+
+void update_baseline(nlohmann::json& baseline, const nlohmann::json& results) {
+  if (!baseline.is_object() || !baseline["cases"].is_array()) {
+    baseline = results;
+    return;
+  }
+  for (const auto& benchCase : results["cases"]) {
+    auto& cases = baseline["cases"];
+    auto baseCase = std::find_if(
+        cases.begin(), cases.end(), [&](const nlohmann::json& element) {
+          return element["name"] == benchCase["name"];
+        });
+    if (baseCase == cases.end() || !same_spec(*baseCase, benchCase)) {
+      if (baseCase != cases.end()) {
+        cases.erase(baseCase);
+      }
+      cases.push_back(benchCase);
+      continue;
+    }
+    auto& baseResults = (*baseCase)["results"];
+    for (const auto& result : benchCase["results"]) {
+      auto base = std::find_if(
+          baseResults.begin(), baseResults.end(),
+          [&](const nlohmann::json& element) {
+            return element["name"] == result["name"];
+          });
+      if (base == baseResults.end()) {
+        baseResults.push_back(result);
+      } else {
+        *base = result;
+      }
+    }
+  }
+}
+
+}  // namespace bench
+}  // namespace sycl_info
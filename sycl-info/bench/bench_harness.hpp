@@ -0,0 +1,123 @@
+////////////////////////////////////////////////////////////////////////////////
+// bench_harness.hpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SYCL_INFO_BENCH_BENCH_HARNESS_HPP
+#define SYCL_INFO_BENCH_BENCH_HARNESS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <nlohmann/json.hpp>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace sycl_info {
+namespace bench {
+
+/// @brief The timings of a benchmark, in nanoseconds per repetition
+///
+struct bench_result {
+  std::string name;
+  std::size_t repetitions;
+  /// @brief The items (e.g. files or configurations) processed per
+  /// repetition
+  std::size_t items;
+  double min;
+  double median;
+  double mean;
+  double p95;
+  double max;
+};
+
+/// @brief Computes the statistics of the samples of a benchmark
+/// @param The name of the benchmark, the time of each repetition in
+/// nanoseconds and the items processed per repetition
+///
+bench_result summarize(const std::string& name, std::vector<double> samples,
+                       std::size_t items);
+
+/// @brief Keeps the compiler from optimizing away what a benchmark computes
+///
+void keep(std::size_t value) noexcept;
+
+/// @brief Times a fixed workload of allocations, string comparisons and
+/// sorting, whose speed follows that of the benchmarks when the machine
+/// slows down as a whole (e.g. frequency scaling or other processes)
+/// @return The fastest of a few repetitions, in nanoseconds
+///
+double calibrate();
+
+/// @brief Runs a benchmark once to warm up, then times each repetition
+/// @param The name of the benchmark, the number of repetitions, the items
+/// processed per repetition and the function to time, which returns a value
+/// derived from what it computed (e.g. the size of a result)
+///
+template <class Function>
+bench_result run_benchmark(const std::string& name, std::size_t repetitions,
+                           std::size_t items, Function&& function) {
+  keep(function());
+  auto samples = std::vector<double>{};
+  samples.reserve(repetitions);
+  for (std::size_t i = 0; i < repetitions; ++i) {
+    const auto start = std::chrono::steady_clock::now();
+    keep(function());
+    const auto end = std::chrono::steady_clock::now();
+    samples.push_back(
+        std::chrono::duration<double, std::nano>(end - start).count());
+  }
+  return summarize(name, std::move(samples), items);
+}
+
+/// @brief Converts a result to the json written by sycl-info-bench
+///
+nlohmann::json to_json(const bench_result& result);
+
+/// @brief Compares the fastest repetition of each result with that of a
+/// baseline written by an earlier run. Noise only ever makes a repetition
+/// slower, so the fastest one is the most stable. Results that were
+/// calibrated (see calibrate()) are compared relative to their calibration,
+/// so that a machine that is slower as a whole does not fail them. The
+/// tolerance is widened by the jitter of either run, i.e. how much slower its
+/// median is than its fastest repetition.
+/// @param The results and the baseline, as written by sycl-info-bench, the
+/// tolerated slowdown in percent and the stream each comparison is reported
+/// to. Benchmarks missing from the baseline are reported but not compared.
+/// @return The number of benchmarks slower than the baseline by more than the
+/// tolerance
+/// @throws sycl_info_error if a case was generated from a different spec
+/// than its baseline
+///
+std::size_t compare_with_baseline(const nlohmann::json& results,
+                                  const nlohmann::json& baseline,
+                                  double tolerance, std::ostream& report);
+
+/// @brief Keeps, for each benchmark, the result with the fastest repetition
+/// out of fastest and results, both as written by sycl-info-bench
+///
+void keep_fastest(nlohmann::json& fastest, const nlohmann::json& results);
+
+/// @brief Adds results to a baseline, replacing the results of the same
+/// benchmarks, and the cases whose spec changed
+///
+void update_baseline(nlohmann::json& baseline, const nlohmann::json& results);
+
+}  // namespace bench
+}  // namespace sycl_info
+
+#endif  // SYCL_INFO_BENCH_BENCH_HARNESS_HPP
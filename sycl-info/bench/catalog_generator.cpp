@@ -0,0 +1,234 @@
+////////////////////////////////////////////////////////////////////////////////
+// catalog_generator.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "catalog_generator.hpp"
+
+#include "impl_finder.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <target_selector/target_selector.hpp>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#include <windows.h>
+#elif __unix__
+#include <unistd.h>
+#else
+#error "Not a windows/POSIX environment"
+#endif
+
+namespace sycl_info {
+namespace bench {
+
+/// @brief The devices of each platform the configurations are drawn from:
+/// enough for every configuration of a file to be distinct
+///
+static std::size_t devices_per_platform(const catalog_spec& spec) {
+  constexpr std::size_t minimumDevices = 16;
+  return std::max(minimumDevices,
+                  (spec.configsPerFile + generated_platforms - 1) /
+                      generated_platforms);
+}
+
+/// @brief FNV-1a, which unlike std::hash gives the same value everywhere
+///
+static std::uint32_t hash(const std::string& str) {
+  auto value = std::uint32_t{2166136261u};
+  for (const auto c : str) {
+    value = (value ^ static_cast<unsigned char>(c)) * 16777619u;
+  }
+  return value;
+}
+
+/// @brief Pads a name with letters up to the length of the spec. The letters
+/// only depend on the seed and on the name.
+///
+static std::string padded_name(const catalog_spec& spec, std::string name) {
+  auto rng = std::mt19937{spec.seed ^ hash(name)};
+  if (!name.empty() && name.size() < spec.nameLength) {
+    name += ' ';
+  }
+  while (name.size() < spec.nameLength) {
+    name += static_cast<char>('a' + rng() % 26);
+  }
+  return name;
+}
+
+static std::string platform_name(const catalog_spec& spec,
+                                 std::size_t platform) {
+  return padded_name(spec, "Platform " + std::to_string(platform));
+}
+
+static std::string platform_vendor(std::size_t platform) {
+  return "Vendor " + std::to_string(platform);
+}
+
+static std::string device_name(const catalog_spec& spec, std::size_t platform,
+                               std::size_t device) {
+  return padded_name(spec, "Device " + std::to_string(platform) + '.' +
+                               std::to_string(device));
+}
+
+static const char* device_type(std::size_t device) {
+  static constexpr const char* types[] = {"CPU", "GPU", "ACCELERATOR"};
+  return types[device % 3];
+}
+
+nlohmann::json generate_impl(const catalog_spec& spec, std::size_t index) {
+  using configs = select<selections::supported_configurations>;
+  using plat_name = select<selections::plat_name>;
+  using plat_vendor = select<selections::plat_vendor>;
+  using dev_type = select<selections::dev_type>;
+  using dev_name = select<selections::dev_name>;
+  using dev_vendor = select<selections::dev_vendor>;
+  using drivers = select<selections::supported_drivers>;
+  using supported_backend = select<selections::supported_backend_targets>;
+  using backend_target = select<selections::backend>;
+  using dev_flags = select<selections::dev_flags>;
+
+  // Each file lists a different selection of the platforms/devices
+  const auto devices = devices_per_platform(spec);
+  auto pool = std::vector<std::size_t>(generated_platforms * devices);
+  std::iota(pool.begin(), pool.end(), std::size_t{0});
+  auto rng = std::mt19937{spec.seed + static_cast<std::uint32_t>(index)};
+  const auto count = std::min(spec.configsPerFile, pool.size());
+  for (std::size_t i = 0; i < count; ++i) {
+    std::swap(pool[i], pool[i + rng() % (pool.size() - i)]);
+  }
+
+  auto impl = nlohmann::json::object();
+  impl["name"] = "Synthetic " + std::to_string(index);
+  impl["vendor"] = "Synthetic Vendor";
+  impl["version"] = "1.0." + std::to_string(index);
+  auto& configList = impl[configs::value] = nlohmann::json::array();
+  for (std::size_t i = 0; i < count; ++i) {
+    const auto platform = pool[i] / devices;
+    const auto device = pool[i] % devices;
+
+    auto config = nlohmann::json::object();
+    config[plat_name::value] = platform_name(spec, platform);
+    config[plat_vendor::value] = platform_vendor(platform);
+    config[dev_type::value] = device_type(device);
+    config[dev_name::value] = device_name(spec, platform, device);
+    config[dev_vendor::value] = platform_vendor(platform);
+    config[drivers::value] = nlohmann::json::array({"1.2", "2.0"});
+    auto& targets = config[supported_backend::value] = nlohmann::json::array();
+    for (std::size_t b = 0; b < spec.backendsPerConfig; ++b) {
+      auto target = nlohmann::json::object();
+      target[backend_target::value] = "BACKEND" + std::to_string(b);
+      target[dev_flags::value] =
+          "-sycl -sycl-target=backend" + std::to_string(b);
+      targets.push_back(std::move(target));
+    }
+    configList.push_back(std::move(config));
+  }
+  return impl;
+}
+
+std::vector<nlohmann::json> generate_catalog(const catalog_spec& spec) {
+  auto impls = std::vector<nlohmann::json>{};
+  impls.reserve(spec.files);
+  for (std::size_t i = 0; i < spec.files; ++i) {
+    impls.push_back(generate_impl(spec, i));
+  }
+  return impls;
+}
+
+using_target_matcher::print_type generate_hardware(const catalog_spec& spec) {
+  auto hardware = using_target_matcher::print_type{};
+  const auto devices = devices_per_platform(spec);
+  for (std::size_t p = 0; p < generated_platforms; ++p) {
+    auto plat = using_target_matcher::platform{};
+    plat.name = platform_name(spec, p);
+    plat.vendor = platform_vendor(p);
+    for (std::size_t d = p % 2; d < devices; d += 2) {
+      auto dev = using_target_matcher::device{};
+      dev.name = device_name(spec, p, d);
+      dev.vendor = platform_vendor(p);
+      dev.type = device_type(d);
+      plat.devices.insert(std::move(dev));
+    }
+    hardware.insert(std::move(plat));
+  }
+  return hardware;
+}
+
+void write_catalog(const catalog_spec& spec, const std::string& directory) {
+  for (std::size_t i = 0; i < spec.files; ++i) {
+    const auto path = concat_path(directory, path_separator,
+                                  "impl-" + std::to_string(i) + ".syclinfo");
+    std::ofstream file{path};
+    if (!file) {
+      throw target_selector::sycl_info_error{"Unable to write " + path};
+    }
+    file << generate_impl(spec, i).dump(2) << '\n';
+  }
+}
+
+#ifdef _WIN32
+std::string make_temporary_directory() {
+  char tempPath[MAX_PATH + 1];
+  const auto length = GetTempPathA(MAX_PATH + 1, tempPath);
+  for (unsigned int attempt = 0; length != 0 && attempt < 100; ++attempt) {
+    const auto path = std::string{tempPath, length} + "sycl-info-bench-" +
+                      std::to_string(_getpid()) + '-' +
+                      std::to_string(attempt);
+    if (_mkdir(path.c_str()) == 0) {
+      return path;
+    }
+  }
+  throw target_selector::sycl_info_error{
+      "Unable to create a temporary directory"};
+}
+
+void remove_directory(const std::string& directory) {
+  for (const auto& entry : list_directory(directory)) {
+    std::remove(concat_path(directory, path_separator, entry).c_str());
+  }
+  _rmdir(directory.c_str());
+}
+#else
+std::string make_temporary_directory() {
+  const char* tmpdir = std::getenv("TMPDIR");
+  auto path = std::string{(tmpdir && *tmpdir) ? tmpdir : "/tmp"} +
+              "/sycl-info-bench-XXXXXX";
+  if (!mkdtemp(&path[0])) {
+    throw target_selector::sycl_info_error{
+        "Unable to create a temporary directory"};
+  }
+  return path;
+}
+
+void remove_directory(const std::string& directory) {
+  for (const auto& entry : list_directory(directory)) {
+    if (entry != "." && entry != "..") {
+      std::remove(concat_path(directory, path_separator, entry).c_str());
+    }
+  }
+  rmdir(directory.c_str());
+}
+#endif
+
+}  // namespace bench
+}  // namespace sycl_info
@@ -0,0 +1,86 @@
+////////////////////////////////////////////////////////////////////////////////
+// catalog_generator.hpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SYCL_INFO_BENCH_CATALOG_GENERATOR_HPP
+#define SYCL_INFO_BENCH_CATALOG_GENERATOR_HPP
+
+#include "impl_matchers.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+namespace sycl_info {
+namespace bench {
+
+/// @brief Describes a synthetic catalog of .syclinfo files. The same
+/// description always generates the same catalog.
+///
+struct catalog_spec {
+  /// @brief The number of .syclinfo files (implementations)
+  std::size_t files;
+  /// @brief The number of platform/device configurations of each file
+  std::size_t configsPerFile;
+  /// @brief The number of backend targets of each configuration
+  std::size_t backendsPerConfig;
+  /// @brief The length of the platform and device names
+  std::size_t nameLength;
+  std::uint32_t seed;
+};
+
+/// @brief The platforms the configurations are drawn from
+///
+constexpr std::size_t generated_platforms = 4;
+
+/// @brief Generates the implementation described by the index-th file of a
+/// catalog
+///
+nlohmann::json generate_impl(const catalog_spec& spec, std::size_t index);
+
+/// @brief Generates every implementation of a catalog
+///
+std::vector<nlohmann::json> generate_catalog(const catalog_spec& spec);
+
+/// @brief Generates the hardware of a system on which every other
+/// platform/device the configurations are drawn from is available, so that
+/// matching finds both supported and unsupported configurations
+///
+using_target_matcher::print_type generate_hardware(const catalog_spec& spec);
+
+/// @brief Writes every implementation of a catalog to an existing directory,
+/// one .syclinfo file each
+/// @throws target_selector::sycl_info_error if a file cannot be written
+///
+void write_catalog(const catalog_spec& spec, const std::string& directory);
+
+/// @brief Creates an empty directory in the system's temporary directory
+/// @throws target_selector::sycl_info_error if it cannot be created
+///
+std::string make_temporary_directory();
+
+/// @brief Removes a directory created by make_temporary_directory() and
+/// the files in it
+///
+void remove_directory(const std::string& directory);
+
+}  // namespace bench
+}  // namespace sycl_info
+
+#endif  // SYCL_INFO_BENCH_CATALOG_GENERATOR_HPP
@@ -0,0 +1,195 @@
+////////////////////////////////////////////////////////////////////////////////
+// stub_icd.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+// A minimal OpenCL ICD with a fixed set of platforms and devices, so that
+// the perf tests time the enumeration of sycl-info against the same
+// hardware on every machine. Only the queries made by target_selector are
+// implemented.
+
+#include <CL/opencl.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#define SYCL_INFO_STUB_ICD_EXPORT __declspec(dllexport)
+#else
+#define SYCL_INFO_STUB_ICD_EXPORT __attribute__((visibility("default")))
+#endif
+
+/// @brief The entry points of the ICD dispatch table used by the loader:
+/// clGetPlatformIDs, clGetPlatformInfo, clGetDeviceIDs and clGetDeviceInfo
+/// come first, the rest is never called
+///
+static void* dispatchTable[128];
+
+struct _cl_platform_id {
+  void* dispatch;
+  std::string name;
+  std::string vendor;
+  std::vector<cl_device_id> devices;
+};
+
+struct _cl_device_id {
+  void* dispatch;
+  cl_device_type type;
+  std::string name;
+  std::string vendor;
+};
+
+namespace {
+constexpr auto stubPlatforms = 4;
+constexpr auto stubDevicesPerPlatform = 8;
+
+std::vector<cl_platform_id>& platforms() {
+  static auto result = []() {
+    constexpr cl_device_type types[] = {CL_DEVICE_TYPE_GPU, CL_DEVICE_TYPE_CPU,
+                                        CL_DEVICE_TYPE_ACCELERATOR};
+    auto created = std::vector<cl_platform_id>{};
+    for (auto p = 0; p < stubPlatforms; ++p) {
+      const auto vendor = "Stub Vendor " + std::to_string(p);
+      auto* platform = new _cl_platform_id{
+          dispatchTable, "Stub Platform " + std::to_string(p), vendor, {}};
+      for (auto d = 0; d < stubDevicesPerPlatform; ++d) {
+        platform->devices.push_back(new _cl_device_id{
+            dispatchTable, types[d % 3],
+            "Stub Device " + std::to_string(p) + "." + std::to_string(d),
+            vendor});
+      }
+      created.push_back(platform);
+    }
+    return created;
+  }();
+  return result;
+}
+
+cl_int string_info(const std::string& value, size_t size, void* out,
+                   size_t* sizeRet) {
+  if (sizeRet) {
+    *sizeRet = value.size() + 1;
+  }
+  if (out) {
+    if (size < value.size() + 1) {
+      return CL_INVALID_VALUE;
+    }
+    std::memcpy(out, value.c_str(), value.size() + 1);
+  }
+  return CL_SUCCESS;
+}
+
+cl_int CL_API_CALL get_platform_ids(cl_uint count, cl_platform_id* out,
+                                    cl_uint* countRet) {
+  const auto& all = platforms();
+  if (countRet) {
+    *countRet = static_cast<cl_uint>(all.size());
+  }
+  for (cl_uint i = 0; out && i < count && i < all.size(); ++i) {
+    out[i] = all[i];
+  }
+  return CL_SUCCESS;
+}
+
+cl_int CL_API_CALL get_platform_info(cl_platform_id platform,
+                                     cl_platform_info param, size_t size,
+                                     void* out, size_t* sizeRet) {
+  switch (param) {
+    case CL_PLATFORM_NAME:
+      return string_info(platform->name, size, out, sizeRet);
+    case CL_PLATFORM_VENDOR:
+      return string_info(platform->vendor, size, out, sizeRet);
+    case CL_PLATFORM_ICD_SUFFIX_KHR:
+      return string_info("STUB", size, out, sizeRet);
+    case CL_PLATFORM_EXTENSIONS:
+      return string_info("cl_khr_icd", size, out, sizeRet);
+    default:
+      return string_info("OpenCL 1.2 stub", size, out, sizeRet);
+  }
+}
+
+cl_int CL_API_CALL get_device_ids(cl_platform_id platform, cl_device_type type,
+                                  cl_uint count, cl_device_id* out,
+                                  cl_uint* countRet) {
+  auto matched = std::vector<cl_device_id>{};
+  for (auto* device : platform->devices) {
+    if (device->type & type) {
+      matched.push_back(device);
+    }
+  }
+  if (countRet) {
+    *countRet = static_cast<cl_uint>(matched.size());
+  }
+  for (cl_uint i = 0; out && i < count && i < matched.size(); ++i) {
+    out[i] = matched[i];
+  }
+  return matched.empty() ? CL_DEVICE_NOT_FOUND : CL_SUCCESS;
+}
+
+cl_int CL_API_CALL get_device_info(cl_device_id device, cl_device_info param,
+                                   size_t size, void* out, size_t* sizeRet) {
+  switch (param) {
+    case CL_DEVICE_NAME:
+      return string_info(device->name, size, out, sizeRet);
+    case CL_DEVICE_VENDOR:
+      return string_info(device->vendor, size, out, sizeRet);
+    case CL_DEVICE_EXTENSIONS:
+      return string_info("cl_khr_spir cl_khr_fp64", size, out, sizeRet);
+    case CL_DRIVER_VERSION:
+      return string_info("1.0", size, out, sizeRet);
+    case CL_DEVICE_TYPE:
+      if (sizeRet) {
+        *sizeRet = sizeof(cl_device_type);
+      }
+      if (out) {
+        if (size < sizeof(cl_device_type)) {
+          return CL_INVALID_VALUE;
+        }
+        std::memcpy(out, &device->type, sizeof(cl_device_type));
+      }
+      return CL_SUCCESS;
+    default:
+      return string_info("", size, out, sizeRet);
+  }
+}
+}  // namespace
+
+extern "C" {
+
+SYCL_INFO_STUB_ICD_EXPORT cl_int CL_API_CALL
+clIcdGetPlatformIDsKHR(cl_uint count, cl_platform_id* out, cl_uint* countRet) {
+  dispatchTable[0] = reinterpret_cast<void*>(&get_platform_ids);
+  dispatchTable[1] = reinterpret_cast<void*>(&get_platform_info);
+  dispatchTable[2] = reinterpret_cast<void*>(&get_device_ids);
+  dispatchTable[3] = reinterpret_cast<void*>(&get_device_info);
+  return get_platform_ids(count, out, countRet);
+}
+
+SYCL_INFO_STUB_ICD_EXPORT void* CL_API_CALL
+clGetExtensionFunctionAddress(const char* name) {
+  return std::strcmp(name, "clIcdGetPlatformIDsKHR") == 0
+             ? reinterpret_cast<void*>(&clIcdGetPlatformIDsKHR)
+             : nullptr;
+}
+
+SYCL_INFO_STUB_ICD_EXPORT cl_int CL_API_CALL
+clGetPlatformInfo(cl_platform_id platform, cl_platform_info param, size_t size,
+                  void* out, size_t* sizeRet) {
+  return get_platform_info(platform, param, size, out, sizeRet);
+}
+
+}  // extern "C"
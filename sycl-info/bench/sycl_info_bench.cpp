@@ -0,0 +1,406 @@
+////////////////////////////////////////////////////////////////////////////////
+// sycl_info_bench.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "config.hpp"
+
+#include "bench_harness.hpp"
+#include "catalog_generator.hpp"
+#include "catalog_parser.hpp"
+#include "compact_catalog.hpp"
+#include "hardware_snapshot.hpp"
+#include "impl_finder.hpp"
+#include "impl_matchers.hpp"
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <lyra/lyra.hpp>
+#include <ostream>
+#include <regex>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace {
+/// @brief Discards everything written to it, so that the dump functions are
+/// timed without the cost of a terminal or a file
+///
+class null_buffer : public std::streambuf {
+ protected:
+  int_type overflow(int_type ch) override { return traits_type::not_eof(ch); }
+  std::streamsize xsputn(const char*, std::streamsize count) override {
+    return count;
+  }
+};
+
+struct bench_options {
+  sycl_info::bench::catalog_spec spec;
+  std::size_t repetitions;
+  bool large;
+  bool enumerate;
+  std::string filter;
+  std::string output;
+  std::string baseline;
+  bool record;
+  double tolerance;
+  std::size_t attempts;
+};
+
+/// @brief Runs the benchmarks of one catalog
+/// @return The json of the case: its spec and the result of each benchmark
+///
+nlohmann::json run_case(const std::string& name,
+                        const sycl_info::bench::catalog_spec& spec,
+                        const bench_options& options, bool enumerate) {
+  using sycl_info::using_target_matcher;
+  using sycl_info::bench::run_benchmark;
+
+  const auto impls = sycl_info::bench::generate_catalog(spec);
+  const auto hardware = sycl_info::bench::generate_hardware(spec);
+  const auto repetitions = options.repetitions;
+  const auto configCount = spec.files * spec.configsPerFile;
+
+  null_buffer discard;
+  std::ostream null{&discard};
+
+  const auto filter = std::regex{options.filter};
+  const auto selected = [&filter](const std::string& benchmark) {
+    return std::regex_search(benchmark, filter);
+  };
+  auto results = nlohmann::json::array();
+  const auto run = [&](const std::string& benchmark, std::size_t items,
+                       const std::function<std::size_t()>& function) {
+    if (!selected(benchmark)) {
+      return;
+    }
+    std::cerr << name << '/' << benchmark << '\n';
+    const auto calibration = sycl_info::bench::calibrate();
+    results.push_back(sycl_info::bench::to_json(
+        run_benchmark(benchmark, repetitions, items, function)));
+    results.back()["calibration_ns"] = calibration;
+  };
+
+  // Enumerates the platforms/devices of the installed ICDs, which the perf
+  // tests replace with the stub ICD. One enumeration is too short to time
+  // reliably.
+  if (enumerate) {
+    constexpr auto enumerations = std::size_t{16};
+    run("enumerate_devices", enumerations, []() {
+      auto platforms = std::size_t{0};
+      for (std::size_t i = 0; i < enumerations; ++i) {
+        platforms += sycl_info::capture_hardware().size();
+      }
+      return platforms;
+    });
+  }
+
+  if (selected("find_sycl_impls")) {
+    const auto directory = sycl_info::bench::make_temporary_directory();
+    try {
+      sycl_info::bench::write_catalog(spec, directory);
+      run("find_sycl_impls", spec.files, [&directory]() {
+        return sycl_info::find_sycl_impls({directory}).size();
+      });
+    } catch (...) {
+      sycl_info::bench::remove_directory(directory);
+      throw;
+    }
+    sycl_info::bench::remove_directory(directory);
+  }
+
+  // The catalog as it is written to the .syclinfo files, parsed by each
+  // backend. Both have to give the same json.
+  if (selected("parse_dom") || selected("parse_schema")) {
+    auto files = std::vector<std::string>{};
+    for (const auto& impl : impls) {
+      files.push_back(impl.dump(2) + '\n');
+      if (sycl_info::parse_catalog_file(files.back(),
+                                        sycl_info::parser_backend::schema) !=
+          impl) {
+        throw std::runtime_error{"The schema parser misread " +
+                                 impl["name"].get<std::string>()};
+      }
+    }
+    for (const auto backend : {sycl_info::parser_backend::dom,
+                               sycl_info::parser_backend::schema}) {
+      run(std::string{"parse_"} + sycl_info::to_string(backend), spec.files,
+          [&files, backend]() {
+            auto members = std::size_t{0};
+            for (const auto& file : files) {
+              members += sycl_info::parse_catalog_file(file, backend).size();
+            }
+            return members;
+          });
+    }
+  }
+
+  run("from_json", spec.files, [&impls]() {
+    auto platforms = std::size_t{0};
+    for (const auto& impl : impls) {
+      platforms += using_target_matcher::from_json(impl).size();
+    }
+    return platforms;
+  });
+
+  // As make_compact_catalog() does, without consuming the catalog
+  run("make_compact_catalog", spec.files, [&impls]() {
+    auto pool = sycl_info::backend_pool{};
+    auto configs = std::size_t{0};
+    for (const auto& impl : impls) {
+      configs += sycl_info::make_compact_impl(impl, pool).configs.size();
+    }
+    return configs;
+  });
+
+  run("match", spec.files, [&impls, &hardware]() {
+    auto platforms = std::size_t{0};
+    for (const auto& impl : impls) {
+      platforms += using_target_matcher::match(impl, hardware).size();
+    }
+    return platforms;
+  });
+
+  // Every configuration of every file is resolved, as --config does
+  using configs =
+      sycl_info::select<sycl_info::selections::supported_configurations>;
+  using plat_name = sycl_info::select<sycl_info::selections::plat_name>;
+  using dev_name = sycl_info::select<sycl_info::selections::dev_name>;
+  run("match_config_with_impls", configCount, [&impls]() {
+    auto flags = std::size_t{0};
+    for (const auto& impl : impls) {
+      for (const auto& conf : impl[configs::value]) {
+        const auto info = sycl_info::match_config_with_impls(
+            sycl_info::config{conf[plat_name::value], conf[dev_name::value]},
+            impl, "");
+        flags += info.deviceFlags.size();
+      }
+    }
+    return flags;
+  });
+
+  run("dump_impls", spec.files, [&impls, &null]() {
+    sycl_info::dump_impls(impls, null);
+    return impls.size();
+  });
+
+  auto matched = std::vector<using_target_matcher::print_type>{};
+  for (const auto& impl : impls) {
+    matched.push_back(using_target_matcher::match(impl, hardware));
+  }
+  run("dump_picked_impl", spec.files, [&matched, &null]() {
+    for (const auto& platforms : matched) {
+      sycl_info::dump_picked_impl(platforms, null);
+    }
+    return matched.size();
+  });
+
+  auto backends = std::vector<sycl_info::backend_info>{};
+  for (const auto& impl : impls) {
+    for (const auto& conf : impl[configs::value]) {
+      backends.push_back(sycl_info::match_config_with_impls(
+          sycl_info::config{conf[plat_name::value], conf[dev_name::value]},
+          impl, ""));
+    }
+  }
+  run("dump_config", backends.size(), [&backends, &null]() {
+    for (const auto& info : backends) {
+      sycl_info::dump_config(info, null);
+    }
+    return backends.size();
+  });
+
+  auto result = nlohmann::json::object();
+  result["name"] = name;
+  result["files"] = spec.files;
+  result["configs_per_file"] = spec.configsPerFile;
+  result["backends_per_config"] = spec.backendsPerConfig;
+  result["name_length"] = spec.nameLength;
+  result["seed"] = spec.seed;
+  result["results"] = std::move(results);
+  return result;
+}
+
+/// @brief Runs the benchmarks of every case
+/// @return The json written by sycl-info-bench
+///
+nlohmann::json run_all(const bench_options& options) {
+  auto cases = nlohmann::json::array();
+  cases.push_back(
+      run_case("default", options.spec, options, options.enumerate));
+  if (options.large) {
+    auto large = options.spec;
+    large.files = 5000;
+    large.configsPerFile = 32;
+    large.backendsPerConfig = 4;
+    large.nameLength = 64;
+    cases.push_back(run_case("large", large, options, false));
+  }
+
+  auto results = nlohmann::json::object();
+  results["benchmark"] = "sycl-info-bench";
+  results["version"] = SYCL_INFO_VERSION;
+  results["cases"] = std::move(cases);
+  return results;
+}
+}  // namespace
+
+int main(int argc, const char** argv) {
+  auto options =
+      bench_options{sycl_info::bench::catalog_spec{100, 8, 2, 32, 1},
+                    10,
+                    false,
+                    false,
+                    "",
+                    "",
+                    "",
+                    false,
+                    25,
+                    1};
+  std::string processName;
+  bool help = false;
+  auto cli =
+      lyra::exe_name(processName)  //
+      | lyra::help(help)           //
+      | lyra::opt(options.spec.files, "count")["--files"](
+            "The number of .syclinfo files of the catalog.")  //
+      | lyra::opt(options.spec.configsPerFile, "count")["--configs"](
+            "The number of platform/device configurations per file.")  //
+      | lyra::opt(options.spec.backendsPerConfig, "count")["--backends"](
+            "The number of backend targets per configuration.")  //
+      | lyra::opt(options.spec.nameLength, "length")["--name-length"](
+            "The length of the platform and device names.")  //
+      | lyra::opt(options.spec.seed, "seed")["--seed"](
+            "The seed the catalog is generated from.")  //
+      | lyra::opt(options.repetitions, "count")["--repetitions"](
+            "The number of timed repetitions of each benchmark.")  //
+      | lyra::opt(options.large)["--large"](
+            "Also runs the benchmarks on a large catalog.")  //
+      | lyra::opt(options.enumerate)["--enumerate"](
+            "Also times the enumeration of the OpenCL platforms/devices.")  //
+      | lyra::opt(options.filter, "regex")["--filter"](
+            "Only runs the benchmarks whose name matches this.")  //
+      | lyra::opt(options.output, "file")["--output"](
+            "Writes the results to a file instead of stdout.")  //
+      | lyra::opt(options.baseline, "file")["--baseline"](
+            "Compares the fastest repetition of each benchmark, relative to a "
+            "calibration workload, with the results of an earlier run and "
+            "fails if one is slower than the tolerance, or if the file does "
+            "not exist. Only in optimized builds.")  //
+      | lyra::opt(options.record)["--record"](
+            "Adds the results to the --baseline file, which is created if "
+            "needed, instead of comparing with it.")  //
+      | lyra::opt(options.tolerance, "percent")["--tolerance"](
+            "The slowdown tolerated by --baseline (default 25), widened by "
+            "the jitter of noisy benchmarks.")  //
+      | lyra::opt(options.attempts, "count")["--attempts"](
+            "Runs the benchmarks up to this many times, keeping the fastest "
+            "result of each: until none regresses when comparing with "
+            "--baseline, every time otherwise (default 1).");
+
+  const auto parsed = cli.parse(lyra::args(argc, argv));
+  if (!parsed) {
+    std::cerr << processName << " command-line error: "
+              << parsed.errorMessage() << '\n'
+              << cli << '\n';
+    return 1;
+  }
+  if (help) {
+    std::cout << cli << '\n';
+    return 0;
+  }
+
+  if (options.record && options.baseline.empty()) {
+    std::cerr << processName << " command-line error: --record needs "
+              << "--baseline\n";
+    return 1;
+  }
+
+  try {
+    const auto comparing = !options.baseline.empty() && !options.record;
+    auto baseline = nlohmann::json{};
+    if (!options.baseline.empty()) {
+#ifndef NDEBUG
+      // Unoptimized timings say nothing about a regression
+      std::cerr << "--baseline needs an optimized build, e.g. "
+                   "CMAKE_BUILD_TYPE=Release\n";
+      return 1;
+#endif
+      std::ifstream file{options.baseline};
+      if (file) {
+        file >> baseline;
+      } else if (comparing) {
+        std::cerr << "No baseline at " << options.baseline
+                  << ": record one with --record (the perf-baseline target)\n";
+        return 1;
+      }
+    }
+
+    // A timing that regresses because of a transient slowdown of the machine
+    // does not regress again on the next attempt
+    const auto attempts = std::max<std::size_t>(options.attempts, 1);
+    auto results = nlohmann::json{};
+    for (std::size_t attempt = 0; attempt < attempts; ++attempt) {
+      auto run = run_all(options);
+      if (attempt == 0) {
+        results = std::move(run);
+      } else {
+        sycl_info::bench::keep_fastest(results, run);
+      }
+      null_buffer discard;
+      std::ostream null{&discard};
+      if (comparing && sycl_info::bench::compare_with_baseline(
+                           results, baseline, options.tolerance, null) == 0) {
+        break;
+      }
+    }
+
+    if (options.output.empty()) {
+      std::cout << results.dump(2) << '\n';
+    } else {
+      std::ofstream file{options.output};
+      if (!file) {
+        throw std::runtime_error{"Unable to write " + options.output};
+      }
+      file << results.dump(2) << '\n';
+    }
+
+    if (options.record) {
+      sycl_info::bench::update_baseline(baseline, results);
+      std::ofstream file{options.baseline};
+      if (!file) {
+        throw std::runtime_error{"Unable to write " + options.baseline};
+      }
+      file << baseline.dump(2) << '\n';
+    } else if (comparing) {
+      const auto regressions = sycl_info::bench::compare_with_baseline(
+          results, baseline, options.tolerance, std::cerr);
+      if (regressions != 0) {
+        std::cerr << regressions << " timings regressed by more than "
+                  << options.tolerance << "% in the fastest of " << attempts
+                  << " attempt(s)\n";
+        return 1;
+      }
+    }
+  } catch (std::exception& e) {
+    std::cerr << e.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
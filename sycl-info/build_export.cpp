@@ -0,0 +1,355 @@
+////////////////////////////////////////////////////////////////////////////////
+// build_export.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "build_export.hpp"
+
+#include "config.hpp"
+#include "hardware_snapshot.hpp"
+#include "impl_finder.hpp"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <functional>
+#include <initializer_list>
+#include <map>
+#include <target_selector/target_selector.hpp>
+
+namespace sycl_info {
+
+export_format parse_export_format(const std::string& format) {
+  if (format == "cmake") {
+    return export_format::cmake;
+  }
+  if (format == "make") {
+    return export_format::make;
+  }
+  if (format == "pkg-config") {
+    return export_format::pkg_config;
+  }
+  if (format == "shell") {
+    return export_format::shell;
+  }
+  throw target_selector::sycl_info_error{
+      "Unknown export format " + format +
+      " (expected cmake, make, pkg-config or shell)"};
+}
+
+/// @brief Converts a name (e.g. a backend) to the characters allowed in the
+/// variables of every format
+///
+static std::string identifier(const std::string& name) {
+  auto result = name;
+  for (auto& c : result) {
+    c = std::isalnum(static_cast<unsigned char>(c))
+            ? static_cast<char>(std::toupper(static_cast<unsigned char>(c)))
+            : '_';
+  }
+  return result;
+}
+
+namespace {
+/// @brief Writes variables in the syntax of a build system
+///
+class export_writer {
+ public:
+  export_writer(export_format format, std::ostream& out)
+      : format_(format), out_(out) {}
+
+  void header() { out_ << "# Generated by sycl-info. Do not edit.\n"; }
+
+  void variable(const std::string& name, const std::string& value) {
+    const auto key = (format_ == export_format::pkg_config)
+                         ? lower_case("SYCL_INFO_" + name)
+                         : "SYCL_INFO_" + name;
+    switch (format_) {
+      case export_format::cmake:
+        out_ << "set(" << key << " \"" << value << "\")\n";
+        break;
+      case export_format::make:
+        out_ << key << " := " << value << '\n';
+        break;
+      case export_format::pkg_config:
+        out_ << key << '=' << value << '\n';
+        break;
+      case export_format::shell:
+        out_ << key << "='" << value << "'\n";
+        break;
+    }
+  }
+
+  /// @brief Writes a string, escaped for the format
+  ///
+  void value(const std::string& name, const std::string& str) {
+    variable(name, escape(str));
+  }
+
+  /// @brief Writes a list: a CMake list, or a space separated list otherwise
+  ///
+  void list(const std::string& name, const std::vector<std::string>& items) {
+    const auto separator = (format_ == export_format::cmake) ? ';' : ' ';
+    std::string joined;
+    for (const auto& item : items) {
+      joined += joined.empty() ? escape(item) : separator + escape(item);
+    }
+    variable(name, joined);
+  }
+
+  /// @brief Ends the file; pkg-config files need a name, a description and
+  /// a version
+  ///
+  void footer(const std::string& name, const std::string& description,
+              const std::string& version) {
+    if (format_ == export_format::pkg_config) {
+      out_ << "\nName: " << name << "\nDescription: " << description
+           << "\nVersion: " << version << '\n';
+    }
+  }
+
+ private:
+  static std::string lower_case(std::string str) {
+    for (auto& c : str) {
+      c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return str;
+  }
+
+  std::string escape(const std::string& str) const {
+    std::string result;
+    for (const auto c : str) {
+      // None of the formats can continue a value on the next line
+      if (c == '\n' || c == '\r') {
+        result += ' ';
+        continue;
+      }
+      switch (format_) {
+        case export_format::cmake:
+          if (c == '\\' || c == '"' || c == '$' || c == ';') {
+            result += '\\';
+          }
+          break;
+        case export_format::make:
+          if (c == '$') {
+            result += '$';
+          } else if (c == '#') {
+            result += '\\';
+          }
+          break;
+        case export_format::pkg_config:
+          if (c == '$') {
+            result += '$';
+          }
+          break;
+        case export_format::shell:
+          if (c == '\'') {
+            result += "'\\'";
+          }
+          break;
+      }
+      result += c;
+    }
+    return result;
+  }
+
+  export_format format_;
+  std::ostream& out_;
+};
+}  // namespace
+
+static std::string string_field(const nlohmann::json& field) {
+  return field.is_string() ? field.get<std::string>() : field.dump();
+}
+
+/// @brief Writes the variables of one implementation, each prefixed by the
+/// given prefix
+///
+static void write_impl_variables(
+    export_writer& writer, const std::string& implPrefix,
+    const unsigned int index, const std::vector<nlohmann::json>& impls,
+    const using_target_matcher::print_type* hardware) {
+  const auto& impl = impls[index - 1];
+  writer.value(implPrefix + "NAME", string_field(impl["name"]));
+  writer.value(implPrefix + "VENDOR", string_field(impl["vendor"]));
+  writer.value(implPrefix + "VERSION", string_field(impl["version"]));
+
+  constexpr bool displayAll = false;
+  const auto matched = match_picked_impl(index, impls, displayAll, hardware);
+
+  auto configs = std::vector<std::string>{};
+  int platformIndex = 1;
+  for (const auto& plat : matched) {
+    int deviceIndex = 1;
+    for (const auto& dev : plat.devices) {
+      const auto configIndex =
+          std::to_string(platformIndex) + ':' + std::to_string(deviceIndex);
+      const auto configPrefix = implPrefix + "CONFIG_" +
+                                std::to_string(platformIndex) + '_' +
+                                std::to_string(deviceIndex) + '_';
+      ++deviceIndex;
+
+      const auto backends =
+          match_config_backends(config{plat.name, dev.name}, impl);
+      if (backends.empty()) {
+        continue;
+      }
+      configs.push_back(configIndex);
+
+      writer.value(configPrefix + "PLATFORM", plat.name);
+      writer.value(configPrefix + "DEVICE", dev.name);
+      auto names = std::vector<std::string>{};
+      for (const auto& info : backends) {
+        names.push_back(info.backend);
+      }
+      writer.list(configPrefix + "BACKENDS", names);
+      writer.value(configPrefix + "DEVICE_FLAGS", backends.front().deviceFlags);
+      for (const auto& info : backends) {
+        writer.value(
+            configPrefix + identifier(info.backend) + "_DEVICE_FLAGS",
+            info.deviceFlags);
+      }
+    }
+    ++platformIndex;
+  }
+  writer.list(implPrefix + "CONFIGS", configs);
+}
+
+// The variables, with "SYCL_INFO_" prepended (lower case for pkg-config):
+//   IMPLS                                   indices of the implementations
+//   IMPL_<i>_NAME, _VENDOR, _VERSION
+//   IMPL_<i>_CONFIGS                        "<p>:<d>" of each configuration
+//   IMPL_<i>_CONFIG_<p>_<d>_PLATFORM, _DEVICE
+//   IMPL_<i>_CONFIG_<p>_<d>_BACKENDS        the default backend first
+//   IMPL_<i>_CONFIG_<p>_<d>_DEVICE_FLAGS    flags of the default backend
+//   IMPL_<i>_CONFIG_<p>_<d>_<BACKEND>_DEVICE_FLAGS
+void write_export(export_format format,
+                  const std::vector<nlohmann::json>& impls,
+                  const std::vector<unsigned int>& indices,
+                  const using_target_matcher::print_type* hardware,
+                  std::ostream& out) {
+  // Enumerate the system once rather than once per implementation
+  auto captured = using_target_matcher::print_type{};
+  if (!hardware && indices.size() > 1) {
+    captured = capture_hardware();
+    hardware = &captured;
+  }
+
+  export_writer writer{format, out};
+  writer.header();
+
+  auto implIndices = std::vector<std::string>{};
+  for (const auto index : indices) {
+    implIndices.push_back(std::to_string(index));
+  }
+  writer.list("IMPLS", implIndices);
+
+  for (const auto index : indices) {
+    write_impl_variables(writer, "IMPL_" + std::to_string(index) + '_', index,
+                         impls, hardware);
+  }
+
+  writer.footer("sycl-info-flags",
+                "SYCL device compiler flags resolved by sycl-info",
+                SYCL_INFO_VERSION);
+}
+
+/// @brief Converts an implementation name to the name of its bundle files,
+/// e.g. "ComputeCpp CE" to "sycl-info-computecpp-ce"
+///
+static std::string bundle_name(const std::string& implName) {
+  auto name = std::string{"sycl-info-"};
+  for (const auto c : implName) {
+    name += std::isalnum(static_cast<unsigned char>(c))
+                ? static_cast<char>(std::tolower(static_cast<unsigned char>(c)))
+                : '-';
+  }
+  return name;
+}
+
+/// @brief Names the bundle of each implementation after the implementation.
+/// Implementations with the same name, e.g. two versions found in different
+/// vendor paths, are told apart by their version, then by their index.
+///
+static std::vector<std::string> bundle_keys(
+    const std::vector<nlohmann::json>& impls) {
+  auto keys = std::vector<std::string>{};
+  for (const auto& impl : impls) {
+    keys.push_back(string_field(impl["name"]));
+  }
+
+  auto disambiguate = [&](const std::function<std::string(std::size_t)>& id) {
+    auto counts = std::map<std::string, std::size_t>{};
+    for (const auto& key : keys) {
+      ++counts[bundle_name(key)];
+    }
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+      if (counts[bundle_name(keys[i])] > 1) {
+        keys[i] += ' ' + id(i);
+      }
+    }
+  };
+  disambiguate([&](std::size_t i) {
+    return string_field(impls[i]["version"]);
+  });
+  disambiguate([](std::size_t i) { return std::to_string(i + 1); });
+  return keys;
+}
+
+// Every configuration listed by an implementation is exported, as if the
+// system had all of their devices: the implementation's own configurations
+// are used as the hardware to match against.
+std::vector<std::string> write_bundles(
+    const std::vector<nlohmann::json>& impls, const std::string& directory) {
+  const auto keys = bundle_keys(impls);
+  auto written = std::vector<std::string>{};
+  for (unsigned int index = 1; index <= impls.size(); ++index) {
+    const auto& impl = impls[index - 1];
+    const auto name = string_field(impl["name"]);
+    const auto& key = keys[index - 1];
+    const auto catalog = using_target_matcher::from_json(impl);
+
+    for (const auto format :
+         {export_format::cmake, export_format::pkg_config}) {
+      const auto path = concat_path(
+          directory, path_separator,
+          bundle_name(key) +
+              (format == export_format::cmake ? ".cmake" : ".pc"));
+      if (std::find(written.begin(), written.end(), path) != written.end()) {
+        // Only an implementation named like another one's name, version
+        // and index gets here
+        throw target_selector::sycl_info_error{
+            "Two implementations would both be written to bundle " + path};
+      }
+      std::ofstream file{path};
+      if (!file) {
+        throw target_selector::sycl_info_error{"Unable to write bundle " +
+                                               path};
+      }
+
+      export_writer writer{format, file};
+      writer.header();
+      write_impl_variables(writer, identifier(key) + '_', index, impls,
+                           &catalog);
+      writer.footer(bundle_name(key), name + " device compiler flags",
+                    string_field(impl["version"]));
+      written.push_back(path);
+    }
+  }
+  return written;
+}
+
+}  // namespace sycl_info
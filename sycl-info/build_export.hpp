@@ -0,0 +1,67 @@
+////////////////////////////////////////////////////////////////////////////////
+// build_export.hpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SYCL_INFO_BUILD_EXPORT_HPP
+#define SYCL_INFO_BUILD_EXPORT_HPP
+
+#include "impl_matchers.hpp"
+#include <nlohmann/json.hpp>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace sycl_info {
+
+/// @brief The build systems the configurations can be exported to
+///
+enum class export_format { cmake, make, pkg_config, shell };
+
+/// @brief Converts the value of --export to an export_format
+/// @throws target_selector::sycl_info_error if the format is unknown
+///
+export_format parse_export_format(const std::string& format);
+
+/// @brief Writes every matched configuration of the given implementations,
+/// and the device flags of every backend of each, as a single file for a
+/// build system. The configurations are numbered as for --config.
+/// @param The format to write, the syclinfo implementations, the indices
+/// (starting at 1) of the implementations to export, optionally the hardware
+/// to match against (the system's devices are enumerated once otherwise) and
+/// a stream to write to
+///
+void write_export(export_format format,
+                  const std::vector<nlohmann::json>& impls,
+                  const std::vector<unsigned int>& indices,
+                  const using_target_matcher::print_type* hardware,
+                  std::ostream& out);
+
+/// @brief Writes a CMake and a pkg-config file for every implementation,
+/// with every configuration it lists and the device flags of each of their
+/// backends, so that the flags can be read without running sycl-info
+/// @param The syclinfo implementations and an existing directory to write
+/// the files to
+/// @return The paths of the files written
+/// @throws target_selector::sycl_info_error if a file cannot be written
+///
+std::vector<std::string> write_bundles(
+    const std::vector<nlohmann::json>& impls, const std::string& directory);
+
+}  // namespace sycl_info
+
+#endif  // SYCL_INFO_BUILD_EXPORT_HPP
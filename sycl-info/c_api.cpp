@@ -0,0 +1,285 @@
+////////////////////////////////////////////////////////////////////////////////
+// c_api.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "sycl_info/sycl_info.h"
+
+#include "config.hpp"
+#include "compact_catalog.hpp"
+#include "hardware_snapshot.hpp"
+#include "impl_finder.hpp"
+#include "impl_matchers.hpp"
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+/// A catalog holds typed records rather than json, as applications may keep
+/// many of them alive
+struct sycl_info_catalog_t {
+  std::vector<sycl_info::compact_impl> impls;
+};
+
+struct sycl_info_snapshot_t {
+  sycl_info::using_target_matcher::print_type hardware;
+};
+
+struct sycl_info_matches_t {
+  struct config {
+    std::string platform;
+    std::string device;
+    std::string type;
+    std::vector<sycl_info::backend_info> backends;
+  };
+  std::vector<config> configs;
+};
+
+namespace {
+thread_local std::string lastError;
+
+/// @brief Runs a function of the C interface, turning the exceptions it
+/// throws into a status. No exception may cross the C interface.
+///
+template <class Function>
+sycl_info_status guarded(Function&& function) noexcept {
+  try {
+    return function();
+  } catch (std::exception& e) {
+    lastError = e.what();
+  } catch (...) {
+    lastError = "Unknown error";
+  }
+  return SYCL_INFO_ERROR;
+}
+
+sycl_info_status invalid_argument(const char* message) {
+  lastError = message;
+  return SYCL_INFO_INVALID_ARGUMENT;
+}
+
+sycl_info_status not_found(const char* message) {
+  lastError = message;
+  return SYCL_INFO_NOT_FOUND;
+}
+}  // namespace
+
+extern "C" {
+
+const char* sycl_info_version(void) { return SYCL_INFO_VERSION; }
+
+const char* sycl_info_last_error(void) { return lastError.c_str(); }
+
+sycl_info_status sycl_info_catalog_create(const char* hint,
+                                          sycl_info_catalog* catalog) {
+  if (!catalog) {
+    return invalid_argument("catalog is NULL");
+  }
+  return guarded([&]() {
+    auto result = std::unique_ptr<sycl_info_catalog_t>{new sycl_info_catalog_t};
+    result->impls =
+        sycl_info::make_compact_catalog(sycl_info::get_impls(hint ? hint : ""));
+    *catalog = result.release();
+    return SYCL_INFO_SUCCESS;
+  });
+}
+
+void sycl_info_catalog_destroy(sycl_info_catalog catalog) { delete catalog; }
+
+size_t sycl_info_catalog_size(sycl_info_catalog catalog) {
+  return catalog ? catalog->impls.size() : 0;
+}
+
+static const sycl_info::compact_impl* catalog_impl(sycl_info_catalog catalog,
+                                                   size_t impl) {
+  if (!catalog || impl >= catalog->impls.size()) {
+    return nullptr;
+  }
+  return &catalog->impls[impl];
+}
+
+const char* sycl_info_impl_name(sycl_info_catalog catalog, size_t impl) {
+  const auto* found = catalog_impl(catalog, impl);
+  return found ? found->name.c_str() : nullptr;
+}
+
+const char* sycl_info_impl_vendor(sycl_info_catalog catalog, size_t impl) {
+  const auto* found = catalog_impl(catalog, impl);
+  return found ? found->vendor.c_str() : nullptr;
+}
+
+const char* sycl_info_impl_version(sycl_info_catalog catalog, size_t impl) {
+  const auto* found = catalog_impl(catalog, impl);
+  return found ? found->version.c_str() : nullptr;
+}
+
+sycl_info_status sycl_info_device_flags(sycl_info_catalog catalog, size_t impl,
+                                        const char* platform,
+                                        const char* device, const char* backend,
+                                        const char** flags) {
+  if (!catalog || impl >= catalog->impls.size() || !platform || !device ||
+      !flags) {
+    return invalid_argument("Invalid catalog, implementation or argument");
+  }
+  return guarded([&]() {
+    // The flags are returned straight from the catalog's records, so they
+    // live as long as the catalog. As for the tool, the first listed
+    // configuration wins.
+    const auto* conf = sycl_info::find_config(
+        sycl_info::config{platform, device}, catalog->impls[impl]);
+    if (!conf) {
+      return not_found("The implementation does not list the configuration");
+    }
+    for (const auto& target : *conf->backends) {
+      if (!backend || target.backend == backend) {
+        *flags = target.deviceFlags.c_str();
+        return SYCL_INFO_SUCCESS;
+      }
+    }
+    return not_found("The configuration does not list the backend");
+  });
+}
+
+sycl_info_status sycl_info_snapshot_capture(sycl_info_snapshot* snapshot) {
+  if (!snapshot) {
+    return invalid_argument("snapshot is NULL");
+  }
+  return guarded([&]() {
+    *snapshot = new sycl_info_snapshot_t{sycl_info::capture_hardware()};
+    return SYCL_INFO_SUCCESS;
+  });
+}
+
+sycl_info_status sycl_info_snapshot_load(const char* path,
+                                         sycl_info_snapshot* snapshot) {
+  if (!path || !snapshot) {
+    return invalid_argument("path or snapshot is NULL");
+  }
+  return guarded([&]() {
+    *snapshot = new sycl_info_snapshot_t{sycl_info::load_snapshot(path)};
+    return SYCL_INFO_SUCCESS;
+  });
+}
+
+sycl_info_status sycl_info_snapshot_save(sycl_info_snapshot snapshot,
+                                         const char* path) {
+  if (!snapshot || !path) {
+    return invalid_argument("snapshot or path is NULL");
+  }
+  return guarded([&]() {
+    std::ofstream file{path};
+    if (!file) {
+      lastError = std::string{"Unable to write snapshot "} + path;
+      return SYCL_INFO_ERROR;
+    }
+    sycl_info::write_snapshot(snapshot->hardware, file);
+    return SYCL_INFO_SUCCESS;
+  });
+}
+
+void sycl_info_snapshot_destroy(sycl_info_snapshot snapshot) {
+  delete snapshot;
+}
+
+sycl_info_status sycl_info_match(sycl_info_catalog catalog, size_t impl,
+                                 sycl_info_snapshot snapshot,
+                                 sycl_info_matches* matches) {
+  if (!catalog || impl >= catalog->impls.size() || !matches) {
+    return invalid_argument("Invalid catalog, implementation or matches");
+  }
+  return guarded([&]() {
+    const auto& picked = catalog->impls[impl];
+    const auto matched = sycl_info::match_supported(
+        sycl_info::supported_platforms(picked),
+        sycl_info::supported_device_types(picked),
+        snapshot ? &snapshot->hardware : nullptr);
+
+    auto result = std::unique_ptr<sycl_info_matches_t>{new sycl_info_matches_t};
+    for (const auto& plat : matched) {
+      for (const auto& dev : plat.devices) {
+        result->configs.push_back(sycl_info_matches_t::config{
+            plat.name, dev.name, dev.type,
+            sycl_info::match_config_backends(
+                sycl_info::config{plat.name, dev.name}, picked)});
+      }
+    }
+    *matches = result.release();
+    return SYCL_INFO_SUCCESS;
+  });
+}
+
+void sycl_info_matches_destroy(sycl_info_matches matches) { delete matches; }
+
+size_t sycl_info_matches_size(sycl_info_matches matches) {
+  return matches ? matches->configs.size() : 0;
+}
+
+static const sycl_info_matches_t::config* matched_config(
+    sycl_info_matches matches, size_t config) {
+  if (!matches || config >= matches->configs.size()) {
+    return nullptr;
+  }
+  return &matches->configs[config];
+}
+
+const char* sycl_info_match_platform(sycl_info_matches matches,
+                                     size_t config) {
+  const auto* conf = matched_config(matches, config);
+  return conf ? conf->platform.c_str() : nullptr;
+}
+
+const char* sycl_info_match_device(sycl_info_matches matches, size_t config) {
+  const auto* conf = matched_config(matches, config);
+  return conf ? conf->device.c_str() : nullptr;
+}
+
+const char* sycl_info_match_device_type(sycl_info_matches matches,
+                                        size_t config) {
+  const auto* conf = matched_config(matches, config);
+  return conf ? conf->type.c_str() : nullptr;
+}
+
+size_t sycl_info_match_backend_count(sycl_info_matches matches,
+                                     size_t config) {
+  const auto* conf = matched_config(matches, config);
+  return conf ? conf->backends.size() : 0;
+}
+
+static const sycl_info::backend_info* matched_backend(
+    sycl_info_matches matches, size_t config, size_t backend) {
+  const auto* conf = matched_config(matches, config);
+  if (!conf || backend >= conf->backends.size()) {
+    return nullptr;
+  }
+  return &conf->backends[backend];
+}
+
+const char* sycl_info_match_backend(sycl_info_matches matches, size_t config,
+                                    size_t backend) {
+  const auto* info = matched_backend(matches, config, backend);
+  return info ? info->backend.c_str() : nullptr;
+}
+
+const char* sycl_info_match_device_flags(sycl_info_matches matches,
+                                         size_t config, size_t backend) {
+  const auto* info = matched_backend(matches, config, backend);
+  return info ? info->deviceFlags.c_str() : nullptr;
+}
+
+}  // extern "C"
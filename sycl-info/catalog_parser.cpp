@@ -0,0 +1,329 @@
+////////////////////////////////////////////////////////////////////////////////
+// catalog_parser.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "catalog_parser.hpp"
+
+#include "config.hpp"
+#include "impl_matchers.hpp"
+#include <cstring>
+#include <istream>
+#include <streambuf>
+#include <target_selector/target_selector.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SYCL_INFO_USE_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace sycl_info {
+
+parser_backend catalog_parser_backend() {
+  auto name = target_selector::getenv_variable("SYCL_INFO_PARSER");
+  if (name.empty()) {
+    name = SYCL_INFO_CATALOG_PARSER;
+  }
+  return name == to_string(parser_backend::dom) ? parser_backend::dom
+                                                : parser_backend::schema;
+}
+
+const char* to_string(const parser_backend backend) noexcept {
+  return backend == parser_backend::dom ? "dom" : "schema";
+}
+
+namespace {
+/// \brief Reads a string through an std::istream without copying it
+///
+class string_buffer : public std::streambuf {
+ public:
+  explicit string_buffer(const std::string& str) {
+    auto* first = const_cast<char*>(str.data());
+    setg(first, first, first + str.size());
+  }
+};
+
+/// \brief Finds the first character of a json string that the schema reader
+/// does not copy as is: a quote, a backslash, a control character or a
+/// non-ASCII character. Sixteen characters are compared at a time where
+/// SSE2 is available.
+///
+const char* find_special(const char* first, const char* last) noexcept {
+#ifdef SYCL_INFO_USE_SSE2
+  const auto quote = _mm_set1_epi8('"');
+  const auto backslash = _mm_set1_epi8('\\');
+  const auto space = _mm_set1_epi8(' ');
+  for (; last - first >= 16; first += 16) {
+    const auto chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+    // As signed bytes, both the control and the non-ASCII characters are
+    // less than a space
+    const auto special = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                     _mm_cmpeq_epi8(chunk, backslash)),
+        _mm_cmplt_epi8(chunk, space));
+    const auto mask = static_cast<unsigned int>(_mm_movemask_epi8(special));
+    if (mask != 0) {
+#ifdef _MSC_VER
+      unsigned long index;
+      _BitScanForward(&index, mask);
+      return first + index;
+#else
+      return first + __builtin_ctz(mask);
+#endif
+    }
+  }
+#endif
+  for (; first != last; ++first) {
+    const auto c = static_cast<unsigned char>(*first);
+    if (c == '"' || c == '\\' || c < 0x20 || c >= 0x80) {
+      break;
+    }
+  }
+  return first;
+}
+
+/// \brief A recursive descent reader of the .syclinfo schema. Each object is
+/// read by a function that knows which members it may have and what their
+/// types are; anything else fails the whole file, which is then left to the
+/// generic parser.
+///
+class schema_reader {
+ public:
+  schema_reader(const char* first, std::size_t size) noexcept
+      : next_(first), last_(first + size) {}
+
+  bool read_impl(nlohmann::json& impl) {
+    impl = nlohmann::json::object();
+    const auto read = read_object([this, &impl](const std::string& key) {
+      using configs = select<selections::supported_configurations>;
+      if (key == "name" || key == "vendor" || key == "version") {
+        return read_string(impl[key]);
+      }
+      if (key == configs::value) {
+        auto& list = impl[key] = nlohmann::json::array();
+        return read_array([this, &list]() {
+          list.push_back(nlohmann::json::object());
+          return read_config(list.back());
+        });
+      }
+      return false;
+    });
+    // Only whitespace can follow
+    skip_whitespace();
+    return read && next_ == last_;
+  }
+
+ private:
+  bool read_config(nlohmann::json& config) {
+    return read_object([this, &config](const std::string& key) {
+      using plat_name = select<selections::plat_name>;
+      using plat_vendor = select<selections::plat_vendor>;
+      using dev_type = select<selections::dev_type>;
+      using dev_name = select<selections::dev_name>;
+      using dev_vendor = select<selections::dev_vendor>;
+      using drivers = select<selections::supported_drivers>;
+      using backends = select<selections::supported_backend_targets>;
+      if (key == plat_name::value || key == plat_vendor::value ||
+          key == dev_type::value || key == dev_name::value ||
+          key == dev_vendor::value) {
+        return read_string(config[key]);
+      }
+      if (key == drivers::value) {
+        auto& list = config[key] = nlohmann::json::array();
+        return read_array([this, &list]() {
+          list.push_back(nlohmann::json{});
+          return read_string(list.back());
+        });
+      }
+      if (key == backends::value) {
+        auto& list = config[key] = nlohmann::json::array();
+        return read_array([this, &list]() {
+          list.push_back(nlohmann::json::object());
+          return read_backend(list.back());
+        });
+      }
+      return false;
+    });
+  }
+
+  bool read_backend(nlohmann::json& target) {
+    return read_object([this, &target](const std::string& key) {
+      using backend = select<selections::backend>;
+      using dev_flags = select<selections::dev_flags>;
+      if (key == backend::value || key == dev_flags::value) {
+        return read_string(target[key]);
+      }
+      return false;
+    });
+  }
+
+  /// \brief Reads an object, calling member(key) with next_ on the value of
+  /// each member. key is only valid until the value is read, as nested
+  /// objects reuse it.
+  ///
+  template <class Member>
+  bool read_object(const Member& member) {
+    if (!consume('{')) {
+      return false;
+    }
+    if (consume('}')) {
+      return true;
+    }
+    do {
+      skip_whitespace();
+      if (!read_string(key_) || !consume(':') || !member(key_)) {
+        return false;
+      }
+    } while (consume(','));
+    return consume('}');
+  }
+
+  /// \brief Reads an array, calling element() with next_ on each element
+  ///
+  template <class Element>
+  bool read_array(const Element& element) {
+    if (!consume('[')) {
+      return false;
+    }
+    if (consume(']')) {
+      return true;
+    }
+    do {
+      if (!element()) {
+        return false;
+      }
+    } while (consume(','));
+    return consume(']');
+  }
+
+  bool read_string(nlohmann::json& value) {
+    auto str = std::string{};
+    if (!read_string(str)) {
+      return false;
+    }
+    value = std::move(str);
+    return true;
+  }
+
+  bool read_string(std::string& str) {
+    skip_whitespace();
+    if (next_ == last_ || *next_ != '"') {
+      return false;
+    }
+    ++next_;
+    str.clear();
+    for (;;) {
+      const auto special = find_special(next_, last_);
+      str.append(next_, special);
+      next_ = special;
+      if (next_ == last_) {
+        return false;
+      }
+      if (*next_ == '"') {
+        ++next_;
+        return true;
+      }
+      if (*next_ != '\\' || ++next_ == last_) {
+        return false;
+      }
+      switch (*next_++) {
+        case '"':
+          str += '"';
+          break;
+        case '\\':
+          str += '\\';
+          break;
+        case '/':
+          str += '/';
+          break;
+        case 'b':
+          str += '\b';
+          break;
+        case 'f':
+          str += '\f';
+          break;
+        case 'n':
+          str += '\n';
+          break;
+        case 'r':
+          str += '\r';
+          break;
+        case 't':
+          str += '\t';
+          break;
+        default:
+          // \u escapes are left to the generic parser
+          return false;
+      }
+    }
+  }
+
+  void skip_whitespace() noexcept {
+    while (next_ != last_ && (*next_ == ' ' || *next_ == '\n' ||
+                              *next_ == '\r' || *next_ == '\t')) {
+      ++next_;
+    }
+  }
+
+  /// \brief Skips whitespace and the given character, if it is next
+  ///
+  bool consume(char c) noexcept {
+    skip_whitespace();
+    if (next_ != last_ && *next_ == c) {
+      ++next_;
+      return true;
+    }
+    return false;
+  }
+
+  const char* next_;
+  const char* last_;
+  /// \brief The key of the member being read, reused across members
+  std::string key_;
+};
+}  // namespace
+
+bool read_schema_file(const char* first, std::size_t size,
+                      nlohmann::json& impl) {
+  return schema_reader{first, size}.read_impl(impl);
+}
+
+nlohmann::json parse_catalog_file(const std::string& contents,
+                                  const parser_backend backend) {
+  auto impl = nlohmann::json{};
+  if (backend == parser_backend::schema &&
+      read_schema_file(contents.data(), contents.size(), impl)) {
+    return impl;
+  }
+
+  // As std::istream is read, anything after the json value is ignored
+  string_buffer buffer{contents};
+  std::istream in{&buffer};
+  in >> impl;
+  return impl;
+}
+
+nlohmann::json parse_catalog_file(const std::string& contents) {
+  return parse_catalog_file(contents, catalog_parser_backend());
+}
+
+}  // namespace sycl_info
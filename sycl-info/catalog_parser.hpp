@@ -0,0 +1,72 @@
+////////////////////////////////////////////////////////////////////////////////
+// catalog_parser.hpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SYCL_INFO_CATALOG_PARSER_HPP
+#define SYCL_INFO_CATALOG_PARSER_HPP
+
+#include <cstddef>
+#include <nlohmann/json.hpp>
+#include <string>
+
+namespace sycl_info {
+
+/// \brief How the .syclinfo files are parsed
+///
+enum class parser_backend {
+  /// \brief A reader that only accepts the fields of the .syclinfo schema,
+  /// dispatches on their names and builds their values directly. A file it
+  /// does not accept is parsed by the dom backend instead, so both backends
+  /// give the same result.
+  schema,
+  /// \brief nlohmann::json's generic parser
+  dom,
+};
+
+/// \brief The backend used by parse_catalog_file(): the one given by the
+/// environment variable SYCL_INFO_PARSER, or the one selected with
+/// -DSYCL_INFO_CATALOG_PARSER when sycl-info was built
+///
+parser_backend catalog_parser_backend();
+
+/// \brief The name of a backend, as accepted by SYCL_INFO_PARSER
+///
+const char* to_string(parser_backend backend) noexcept;
+
+/// \brief Parses the contents of a .syclinfo file
+/// \throws nlohmann::json::exception if it is not valid json
+///
+nlohmann::json parse_catalog_file(const std::string& contents,
+                                  parser_backend backend);
+
+/// \brief Parses the contents of a .syclinfo file with the backend selected
+/// by catalog_parser_backend()
+///
+nlohmann::json parse_catalog_file(const std::string& contents);
+
+/// \brief Reads the contents of a .syclinfo file with the schema reader only
+/// \returns false if the file does not follow the schema, uses other
+/// escapes than the single-character ones, or holds non-ASCII characters;
+/// impl is left unspecified then
+///
+bool read_schema_file(const char* first, std::size_t size,
+                      nlohmann::json& impl);
+
+}  // namespace sycl_info
+
+#endif  // SYCL_INFO_CATALOG_PARSER_HPP
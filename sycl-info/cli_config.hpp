@@ -44,6 +44,9 @@ class cli_config {
     if (!result) {
       raise_error(result.errorMessage(), cli);
     }
+    if (planTargets_ && impl_.empty()) {
+      raise_error("--plan-targets requires --impl", cli);
+    }
   }
 
   /// \brief Returns the name of the running process.
@@ -99,6 +102,17 @@ class cli_config {
     return hint_;
   }
 
+  /// \brief Returns how the directories are searched for .syclinfo files
+  /// \returns The depth given with --search-depth and the patterns given
+  ///          with --prune
+  ///
+  SYCL_INFO_NODISCARD search_options get_search_options() const {
+    auto options = search_options{};
+    options.depth = searchDepth_;
+    options.prune = split(prune_, ',');
+    return options;
+  }
+
   /// \brief Returns if the user has provided an argument for the option --impl
   /// \returns True if the user passed a --impl, false otherwise
   ///
@@ -136,6 +150,120 @@ class cli_config {
     return target_;
   }
 
+  /// \brief Returns if the user has asked for a hardware snapshot to be written
+  /// \returns True if the user passed --snapshot-out, false otherwise
+  ///
+  SYCL_INFO_NODISCARD bool snapshot_out() const noexcept {
+    return !snapshotOut_.empty();
+  }
+
+  /// \brief Returns the member snapshotOut_
+  /// \returns The path to write the hardware snapshot to
+  ///
+  SYCL_INFO_NODISCARD const std::string& get_snapshot_out() const noexcept {
+    return snapshotOut_;
+  }
+
+  /// \brief Returns if the user has asked for the hardware to be read from a
+  /// snapshot instead of being queried through OpenCL
+  /// \returns True if the user passed --snapshot-in, false otherwise
+  ///
+  SYCL_INFO_NODISCARD bool snapshot_in() const noexcept {
+    return !snapshotIn_.empty();
+  }
+
+  /// \brief Returns the member snapshotIn_
+  /// \returns The path to read the hardware snapshot from
+  ///
+  SYCL_INFO_NODISCARD const std::string& get_snapshot_in() const noexcept {
+    return snapshotIn_;
+  }
+
+  /// \brief Returns if the user has asked for the coverage of a fleet of
+  /// hardware snapshots
+  /// \returns True if the user passed --fleet, false otherwise
+  ///
+  SYCL_INFO_NODISCARD bool fleet() const noexcept { return !fleet_.empty(); }
+
+  /// \brief Returns the member fleet_
+  /// \returns The path to the directory of hardware snapshots
+  ///
+  SYCL_INFO_NODISCARD const std::string& get_fleet() const noexcept {
+    return fleet_;
+  }
+
+  /// \brief Returns whether or not the user has asked for the fewest back-ends
+  ///        that cover the matched platforms/devices
+  /// \returns true if the user passed --plan-targets, false otherwise
+  ///
+  SYCL_INFO_NODISCARD bool plan_targets() const noexcept {
+    return planTargets_;
+  }
+
+  /// \brief Returns if the user has asked for the configurations to be
+  ///        exported for a build system
+  /// \returns True if the user passed --export, false otherwise
+  ///
+  SYCL_INFO_NODISCARD bool exporting() const noexcept {
+    return !export_.empty();
+  }
+
+  /// \brief Returns the member export_
+  /// \returns The build system to export the configurations for
+  ///
+  SYCL_INFO_NODISCARD const std::string& get_export() const noexcept {
+    return export_;
+  }
+
+  /// \brief Returns if the user has asked for the flag bundles of every
+  ///        implementation to be written
+  /// \returns True if the user passed --bundle-dir, false otherwise
+  ///
+  SYCL_INFO_NODISCARD bool bundle_dir() const noexcept {
+    return !bundleDir_.empty();
+  }
+
+  /// \brief Returns the member bundleDir_
+  /// \returns The directory to write the flag bundles to
+  ///
+  SYCL_INFO_NODISCARD const std::string& get_bundle_dir() const noexcept {
+    return bundleDir_;
+  }
+
+  /// \brief Returns the member format_
+  /// \returns The output format specified by the user, empty for text
+  ///
+  SYCL_INFO_NODISCARD const std::string& get_format() const noexcept {
+    return format_;
+  }
+
+  /// \brief Returns whether or not the user has asked for the time spent in
+  ///        each phase to be reported
+  /// \returns true if the user passed --timings, false otherwise
+  ///
+  SYCL_INFO_NODISCARD bool timings() const noexcept { return timings_; }
+
+  /// \brief Returns if the user has asked for a trace of the phases to be
+  ///        written
+  /// \returns True if the user passed --trace, false otherwise
+  ///
+  SYCL_INFO_NODISCARD bool trace() const noexcept { return !trace_.empty(); }
+
+  /// \brief Returns the member trace_
+  /// \returns The path to write the Chrome trace to
+  ///
+  SYCL_INFO_NODISCARD const std::string& get_trace() const noexcept {
+    return trace_;
+  }
+
+  /// \brief Returns whether or not the user has asked for the memory used by
+  ///        the catalog, the snapshot and the match results to be reported
+  /// \returns true if the user passed --memory-report, false otherwise
+  ///
+  SYCL_INFO_NODISCARD bool memory_report() const noexcept {
+    return memoryReport_;
+  }
+
  private:
   std::string processName_;
   bool help_{false};
@@ -146,8 +274,20 @@ class cli_config {
   bool checkSupport_{false};
   std::string compilerTarget_;
   std::string hint_;
+  unsigned int searchDepth_{0};
+  std::string prune_;
   std::string impl_;
   std::string config_;
+  std::string snapshotOut_;
+  std::string snapshotIn_;
+  std::string fleet_;
+  bool planTargets_{false};
+  std::string format_;
+  std::string export_;
+  std::string bundleDir_;
+  bool timings_{false};
+  std::string trace_;
+  bool memoryReport_{false};
 
   /// \brief Throws an exception with a reason that has a stable prefix and a
   ///        user-defined suffix.
@@ -178,13 +318,49 @@ class cli_config {
             "platform/device configuration.")  //
       | lyra::opt(hint_, "path_to_syclinfo")["--hint"](
             "Specifies a path to a directory containing .syclinfo files.")  //
+      | lyra::opt(searchDepth_, "depth")["--search-depth"](
+            "Also searches this many levels of subdirectories of each "
+            "directory for .syclinfo files (default: 0).")  //
+      | lyra::opt(prune_, "patterns")["--prune"](
+            "Skips the subdirectories whose name matches one of these "
+            "comma-separated patterns ('*' and '?' are wildcards).")  //
       | lyra::opt(config_, "config")["--config"](
             "Selects a platform/device configuration from an impl.")  //
       | lyra::opt(target_, "target")["--target"](
             "Selects a SYCL back-end from a platform/device configuration.")  //
       | lyra::opt(impl_, "impl")["--impl"](
             "Selects a SYCL implementation and displays platform/device "
-            "configurations (index starts at 1)."))
+            "configurations (index starts at 1).")  //
+      | lyra::opt(snapshotOut_, "file")["--snapshot-out"](
+            "Writes a snapshot of the available platforms/devices to a "
+            "file.")  //
+      | lyra::opt(snapshotIn_, "file")["--snapshot-in"](
+            "Reads the platforms/devices from a snapshot file instead of "
+            "querying OpenCL.")  //
+      | lyra::opt(fleet_, "dir")["--fleet"](
+            "Displays which implementations/back-ends cover a directory of "
+            "snapshot files.")  //
+      | lyra::opt(planTargets_)["--plan-targets"](
+            "Outputs the fewest back-ends of an impl, and their device flags, "
+            "that support every matched platform/device.")  //
+      | lyra::opt(format_, "text|json|ndjson")["--format"](
+            "Selects the output format of the implementations, "
+            "platform/device configurations and device flags.")  //
+      | lyra::opt(export_, "cmake|make|pkg-config|shell")["--export"](
+            "Writes the device flags of every backend of every supported "
+            "platform/device configuration as a single build system file.")  //
+      | lyra::opt(bundleDir_, "dir")["--bundle-dir"](
+            "Writes a CMake and a pkg-config file with the device flags of "
+            "every configuration of each implementation to a directory.")  //
+      | lyra::opt(timings_)["--timings"](
+            "Reports the time spent in each phase (directory scans, parsing, "
+            "OpenCL queries, matching, output) to stderr.")  //
+      | lyra::opt(trace_, "file")["--trace"](
+            "Writes the timed phases to a file in the Chrome trace event "
+            "format.")  //
+      | lyra::opt(memoryReport_)["--memory-report"](
+            "Reports the peak RSS and the bytes held by the catalog, the "
+            "hardware snapshot and the match results to stderr."))
 };
 }  // namespace sycl_info
 
@@ -0,0 +1,173 @@
+////////////////////////////////////////////////////////////////////////////////
+// compact_catalog.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "compact_catalog.hpp"
+
+#include "utility.hpp"
+#include <target_selector/target_selector.hpp>
+#include <utility>
+
+namespace sycl_info {
+
+/// @brief Returns a field that is expected to be a string. Like the C
+/// interface, other values are kept as their json text.
+///
+static std::string string_field(const nlohmann::json& field) {
+  return field.is_string() ? field.get<std::string>() : field.dump();
+}
+
+backend_list backend_pool::intern(const nlohmann::json& targets) {
+  using backend = select<selections::backend>;
+  using dev_flags = select<selections::dev_flags>;
+
+  const auto field = [](const nlohmann::json& target,
+                        const char* key) -> const std::string& {
+    return target.at(key).get_ref<const std::string&>();
+  };
+
+  fnv1a_hash hash;
+  for (const auto& target : targets) {
+    hash.update(field(target, backend::value));
+    hash.update(field(target, dev_flags::value));
+  }
+
+  const auto candidates = lists_.equal_range(hash.value());
+  for (auto it = candidates.first; it != candidates.second; ++it) {
+    const auto& stored = *it->second;
+    if (stored.size() != targets.size()) {
+      continue;
+    }
+    auto equal = true;
+    for (std::size_t i = 0; equal && i < stored.size(); ++i) {
+      equal = stored[i].backend == field(targets[i], backend::value) &&
+              stored[i].deviceFlags == field(targets[i], dev_flags::value);
+    }
+    if (equal) {
+      return it->second;
+    }
+  }
+
+  auto list = std::make_shared<std::vector<backend_info>>();
+  list->reserve(targets.size());
+  for (const auto& target : targets) {
+    list->push_back(backend_info{field(target, backend::value),
+                                 field(target, dev_flags::value)});
+  }
+  return lists_.emplace(hash.value(), std::move(list))->second;
+}
+
+compact_impl make_compact_impl(const nlohmann::json& impl) {
+  auto pool = backend_pool{};
+  return make_compact_impl(impl, pool);
+}
+
+compact_impl make_compact_impl(const nlohmann::json& impl,
+                               backend_pool& pool) {
+  using supported_config = select<selections::supported_configurations>;
+  using plat_name = select<selections::plat_name>;
+  using plat_vendor = select<selections::plat_vendor>;
+  using dev_name = select<selections::dev_name>;
+  using dev_vendor = select<selections::dev_vendor>;
+  using dev_type = select<selections::dev_type>;
+  using drivers = select<selections::supported_drivers>;
+  using supported_backend = select<selections::supported_backend_targets>;
+
+  auto result = compact_impl{};
+  result.name = string_field(impl.at("name"));
+  result.vendor = string_field(impl.at("vendor"));
+  result.version = string_field(impl.at("version"));
+
+  const auto& configs = impl.at(supported_config::value);
+  result.configs.reserve(configs.size());
+  for (const auto& config : configs) {
+    auto conf = compact_config{};
+    conf.platformName = config.at(plat_name::value).get<std::string>();
+    conf.platformVendor = config.at(plat_vendor::value).get<std::string>();
+    conf.deviceType = config.value(dev_type::value, std::string{});
+    conf.deviceName = config.at(dev_name::value).get<std::string>();
+    conf.deviceVendor = config.at(dev_vendor::value).get<std::string>();
+
+    const auto& driverList = config.at(drivers::value);
+    conf.drivers.reserve(driverList.size());
+    for (const auto& driver : driverList) {
+      conf.drivers.push_back(driver.get<std::string>());
+    }
+
+    conf.backends = pool.intern(config.at(supported_backend::value));
+    result.configs.push_back(std::move(conf));
+  }
+  return result;
+}
+
+std::vector<compact_impl> make_compact_catalog(
+    std::vector<nlohmann::json> impls) {
+  auto catalog = std::vector<compact_impl>{};
+  catalog.reserve(impls.size());
+  auto pool = backend_pool{};
+  for (auto& impl : impls) {
+    catalog.push_back(make_compact_impl(impl, pool));
+    impl = nullptr;
+  }
+  return catalog;
+}
+
+using_target_matcher::print_type supported_platforms(
+    const compact_impl& impl) {
+  using_target_matcher::print_type result;
+  for (const auto& conf : impl.configs) {
+    using_target_matcher::platform plat = {conf.platformName,
+                                           conf.platformVendor, {}};
+    using_target_matcher::device dev = {conf.deviceName, conf.deviceVendor,
+                                        conf.drivers, conf.deviceType, {}};
+
+    auto insertedPos = result.insert(std::move(plat));
+    insertedPos.first->devices.insert(std::move(dev));
+  }
+  return result;
+}
+
+device_type_map supported_device_types(const compact_impl& impl) {
+  auto deviceTypes = device_type_map{};
+  for (const auto& conf : impl.configs) {
+    // An empty device type selects every device type, as "*" does
+    const auto type = target_selector::match_device_type(conf.deviceType);
+    auto& mask = deviceTypes[conf.platformName];
+    mask |= (type != 0) ? type : cl_device_type{CL_DEVICE_TYPE_ALL};
+  }
+  return deviceTypes;
+}
+
+const compact_config* find_config(const config& conf,
+                                  const compact_impl& impl) noexcept {
+  for (const auto& candidate : impl.configs) {
+    if (candidate.platformName == conf.platform &&
+        candidate.deviceName == conf.device) {
+      return &candidate;
+    }
+  }
+  return nullptr;
+}
+
+std::vector<backend_info> match_config_backends(const config& conf,
+                                                const compact_impl& impl) {
+  const auto* found = find_config(conf, impl);
+  return found ? *found->backends : std::vector<backend_info>{};
+}
+
+}  // namespace sycl_info
@@ -0,0 +1,130 @@
+////////////////////////////////////////////////////////////////////////////////
+// compact_catalog.hpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SYCL_INFO_COMPACT_CATALOG_HPP
+#define SYCL_INFO_COMPACT_CATALOG_HPP
+
+#include "impl_matchers.hpp"
+#include <cstdint>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sycl_info {
+
+/// @brief The backends of a configuration. Identical lists are stored once
+/// and shared by every configuration listing them (see backend_pool).
+///
+using backend_list = std::shared_ptr<const std::vector<backend_info>>;
+
+/// @brief A configuration of a syclinfo file as a typed record, holding only
+/// the fields sycl-info reads
+///
+struct compact_config {
+  std::string platformName;
+  std::string platformVendor;
+  /// @brief Empty when the configuration does not list a device type
+  std::string deviceType;
+  std::string deviceName;
+  std::string deviceVendor;
+  std::vector<std::string> drivers;
+  /// @brief Never null
+  backend_list backends;
+};
+
+/// @brief A syclinfo implementation as a typed record. It takes a fraction
+/// of the memory of its json DOM, so that long-lived catalogs (e.g. those of
+/// the sycl_info library) stay small.
+///
+struct compact_impl {
+  std::string name;
+  std::string vendor;
+  std::string version;
+  std::vector<compact_config> configs;
+};
+
+/// @brief Hash-conses supported_backend_targets lists: vendors repeat the
+/// same backends and device flags for every configuration they list, so
+/// each distinct list is converted and stored only once
+///
+class backend_pool {
+ public:
+  /// @brief Returns the stored list equal to a supported_backend_targets
+  /// json array, converting and storing it if it is new. A list that is
+  /// already stored is found without allocating.
+  /// @throws nlohmann::json::exception if a target is missing a field
+  ///
+  backend_list intern(const nlohmann::json& targets);
+
+  /// @brief Returns the number of distinct lists stored
+  ///
+  std::size_t size() const noexcept { return lists_.size(); }
+
+ private:
+  std::unordered_multimap<std::uint64_t, backend_list> lists_;
+};
+
+/// @brief Converts a syclinfo json to its typed record
+/// @param The json and the pool its backend lists are shared through
+/// @throws nlohmann::json::exception if a field is missing or of the wrong
+/// type
+///
+compact_impl make_compact_impl(const nlohmann::json& impl, backend_pool& pool);
+
+/// @brief Converts a syclinfo json to its typed record, sharing the backend
+/// lists of its own configurations only
+///
+compact_impl make_compact_impl(const nlohmann::json& impl);
+
+/// @brief Converts a catalog to typed records. Each json DOM is released as
+/// soon as its record is built, so the catalog is never held twice, and the
+/// backend lists are shared across every implementation.
+///
+std::vector<compact_impl> make_compact_catalog(
+    std::vector<nlohmann::json> impls);
+
+/// @brief The platforms/devices supported by an implementation, as
+/// using_target_matcher::from_json() returns them for its json
+///
+using_target_matcher::print_type supported_platforms(const compact_impl& impl);
+
+/// @brief The device types listed by each platform of an implementation, as
+/// supported_device_types() returns them for its json
+///
+device_type_map supported_device_types(const compact_impl& impl);
+
+/// @brief Finds the first configuration of an implementation with the
+/// platform and device of conf
+/// @return The configuration or nullptr
+///
+const compact_config* find_config(const config& conf,
+                                  const compact_impl& impl) noexcept;
+
+/// @brief Returns every backend of the first configuration of an
+/// implementation with the platform and device of conf, as
+/// match_config_backends() does for its json
+///
+std::vector<backend_info> match_config_backends(const config& conf,
+                                                const compact_impl& impl);
+
+}  // namespace sycl_info
+
+#endif  // SYCL_INFO_COMPACT_CATALOG_HPP
@@ -0,0 +1,140 @@
+////////////////////////////////////////////////////////////////////////////////
+// embedded_catalog.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "embedded_catalog.hpp"
+
+#include "embedded_catalog_data.hpp"
+#include "impl_matchers.hpp"
+#include "utility.hpp"
+#include <algorithm>
+#include <string>
+#include <target_selector/scoped_timer.hpp>
+
+namespace sycl_info {
+
+static nlohmann::json to_json(const embedded::configuration& conf) {
+  using plat_name = select<selections::plat_name>;
+  using plat_vendor = select<selections::plat_vendor>;
+  using dev_type = select<selections::dev_type>;
+  using dev_name = select<selections::dev_name>;
+  using dev_vendor = select<selections::dev_vendor>;
+  using drivers = select<selections::supported_drivers>;
+  using supported_backend = select<selections::supported_backend_targets>;
+  using backend_target = select<selections::backend>;
+  using dev_flags = select<selections::dev_flags>;
+
+  auto config = nlohmann::json::object();
+  config[plat_name::value] = conf.platformName;
+  config[plat_vendor::value] = conf.platformVendor;
+  config[dev_type::value] = conf.deviceType;
+  config[dev_name::value] = conf.deviceName;
+  config[dev_vendor::value] = conf.deviceVendor;
+
+  auto& driverList = config[drivers::value] = nlohmann::json::array();
+  for (std::size_t i = 0; i < conf.driverCount; ++i) {
+    driverList.push_back(conf.drivers[i]);
+  }
+
+  auto& targets = config[supported_backend::value] = nlohmann::json::array();
+  for (std::size_t i = 0; i < conf.targetCount; ++i) {
+    auto target = nlohmann::json::object();
+    target[backend_target::value] = conf.targets[i].backend;
+    target[dev_flags::value] = conf.targets[i].deviceFlags;
+    targets.push_back(std::move(target));
+  }
+  return config;
+}
+
+std::vector<nlohmann::json> embedded_impls() {
+  target_selector::scoped_timer timer{"embedded catalog"};
+  using configs = select<selections::supported_configurations>;
+
+  auto impls = std::vector<nlohmann::json>{};
+  impls.reserve(embedded::implementation_count);
+  for (std::size_t i = 0; i < embedded::implementation_count; ++i) {
+    const auto& embeddedImpl = embedded::implementations[i];
+    auto impl = nlohmann::json::object();
+    impl["name"] = embeddedImpl.name;
+    impl["vendor"] = embeddedImpl.vendor;
+    impl["version"] = embeddedImpl.version;
+
+    auto& configList = impl[configs::value] = nlohmann::json::array();
+    for (std::size_t c = 0; c < embeddedImpl.configCount; ++c) {
+      configList.push_back(to_json(embeddedImpl.configs[c]));
+    }
+    impls.push_back(std::move(impl));
+  }
+  return impls;
+}
+
+void merge_impls(std::vector<nlohmann::json>& impls,
+                 std::vector<nlohmann::json> found) {
+  const auto embeddedCount = impls.size();
+  for (auto& impl : found) {
+    const auto last =
+        impls.begin() + static_cast<std::ptrdiff_t>(embeddedCount);
+    const auto replaced =
+        std::find_if(impls.begin(), last, [&](const nlohmann::json& other) {
+          return other["name"] == impl["name"];
+        });
+    if (replaced != last) {
+      *replaced = std::move(impl);
+    } else {
+      impls.push_back(std::move(impl));
+    }
+  }
+}
+
+std::uint64_t embedded_catalog_fingerprint() noexcept {
+  fnv1a_hash hash;
+  const auto update = [&hash](const char* str) {
+    hash.update(str, std::char_traits<char>::length(str) + 1);
+  };
+  // The lengths of the lists keep them from being confused with each other
+  const auto update_count = [&hash](std::size_t count) {
+    hash.update(reinterpret_cast<const char*>(&count), sizeof(count));
+  };
+  for (std::size_t i = 0; i < embedded::implementation_count; ++i) {
+    const auto& impl = embedded::implementations[i];
+    update(impl.name);
+    update(impl.vendor);
+    update(impl.version);
+    update_count(impl.configCount);
+    for (std::size_t c = 0; c < impl.configCount; ++c) {
+      const auto& conf = impl.configs[c];
+      update(conf.platformName);
+      update(conf.platformVendor);
+      update(conf.deviceType);
+      update(conf.deviceName);
+      update(conf.deviceVendor);
+      update_count(conf.driverCount);
+      for (std::size_t d = 0; d < conf.driverCount; ++d) {
+        update(conf.drivers[d]);
+      }
+      update_count(conf.targetCount);
+      for (std::size_t t = 0; t < conf.targetCount; ++t) {
+        update(conf.targets[t].backend);
+        update(conf.targets[t].deviceFlags);
+      }
+    }
+  }
+  return hash.value();
+}
+
+}  // namespace sycl_info
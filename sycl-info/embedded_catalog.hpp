@@ -0,0 +1,84 @@
+////////////////////////////////////////////////////////////////////////////////
+// embedded_catalog.hpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SYCL_INFO_EMBEDDED_CATALOG_HPP
+#define SYCL_INFO_EMBEDDED_CATALOG_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <vector>
+
+namespace sycl_info {
+
+/// @brief The layout of the .syclinfo files compiled into sycl-info (see
+/// SYCL_INFO_EMBEDDED_CATALOG). Empty lists are a nullptr and a count of 0.
+///
+namespace embedded {
+
+struct backend_target {
+  const char* backend;
+  const char* deviceFlags;
+};
+
+struct configuration {
+  const char* platformName;
+  const char* platformVendor;
+  const char* deviceType;
+  const char* deviceName;
+  const char* deviceVendor;
+  const char* const* drivers;
+  std::size_t driverCount;
+  const backend_target* targets;
+  std::size_t targetCount;
+};
+
+struct implementation {
+  const char* name;
+  const char* vendor;
+  const char* version;
+  const configuration* configs;
+  std::size_t configCount;
+};
+
+}  // namespace embedded
+
+/// @brief Builds the implementations compiled into sycl-info, without any
+/// file I/O or parsing
+/// @returns the json representation of each embedded implementation, as
+/// read from its .syclinfo file, or an empty vector if none were embedded
+///
+std::vector<nlohmann::json> embedded_impls();
+
+/// @brief Adds implementations found at runtime to the embedded ones. An
+/// implementation with the name of an embedded one replaces it, keeping its
+/// index; the others are appended.
+/// @param The embedded implementations and the ones found at runtime
+///
+void merge_impls(std::vector<nlohmann::json>& impls,
+                 std::vector<nlohmann::json> found);
+
+/// @brief Computes the FNV-1a hash of the implementations compiled into
+/// sycl-info, without building their json representation
+///
+std::uint64_t embedded_catalog_fingerprint() noexcept;
+
+}  // namespace sycl_info
+
+#endif  // SYCL_INFO_EMBEDDED_CATALOG_HPP
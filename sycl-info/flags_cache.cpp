@@ -0,0 +1,194 @@
+////////////////////////////////////////////////////////////////////////////////
+// flags_cache.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "flags_cache.hpp"
+
+#include "batched_io.hpp"
+#include "config.hpp"
+#include "embedded_catalog.hpp"
+#include "impl_finder.hpp"
+#include "shared_catalog.hpp"
+#include "utility.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <target_selector/target_selector.hpp>
+
+#ifdef __unix__
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace sycl_info {
+
+/// \brief Changed whenever the layout of the entries changes
+///
+constexpr int flags_cache_format = 1;
+
+std::string flags_cache_directory() {
+#ifdef __unix__
+  return target_selector::getenv_variable("SYCL_INFO_CACHE_DIR");
+#else
+  return std::string{};
+#endif
+}
+
+/// \brief Removes the whitespace around a string
+///
+static std::string trimmed(const std::string& str) {
+  const auto space = " \t\r\n";
+  const auto first = str.find_first_not_of(space);
+  if (first == std::string::npos) {
+    return std::string{};
+  }
+  return str.substr(first, str.find_last_not_of(space) - first + 1);
+}
+
+std::uint64_t icd_fingerprint() {
+  const auto vendors = target_selector::getenv_variable("OCL_ICD_VENDORS");
+  const auto filenames = target_selector::getenv_variable("OCL_ICD_FILENAMES");
+  fnv1a_hash hash;
+  hash.update(vendors);
+  hash.update(filenames);
+
+  // Each .icd file names the library of a driver
+  const auto directory = vendors.empty() ? std::string{"/etc/OpenCL/vendors"}
+                                         : vendors;
+  auto icds = std::vector<std::string>{};
+  for (const auto& name : list_directory(directory)) {
+    if (ends_with_suffix(name, ".icd")) {
+      icds.push_back(concat_path(directory, path_separator, name));
+    }
+  }
+  std::sort(icds.begin(), icds.end());
+
+  auto libraries = split<char>(filenames, ':');
+  for (const auto& icd : read_files(icds)) {
+    hash.update(icd.path);
+    if (icd.read) {
+      hash.update(icd.contents);
+      libraries.push_back(trimmed(icd.contents));
+    }
+  }
+  // A library given without a directory is searched for by the dynamic
+  // loader: only its name is part of the fingerprint then
+  update_stamps(hash, libraries);
+  return hash.value();
+}
+
+/// \brief Computes the fingerprint of the catalog a query is resolved
+/// against: the implementations compiled into sycl-info and the .syclinfo
+/// files found in the directories searched
+///
+static std::uint64_t query_catalog_fingerprint(const std::string& hint) {
+  impl_discovery discovery{get_vendor_paths(hint)};
+  fnv1a_hash hash;
+  hash.update(std::to_string(embedded_catalog_fingerprint()));
+  hash.update(std::to_string(catalog_fingerprint(discovery.candidates())));
+  return hash.value();
+}
+
+/// \brief Computes the fingerprint of the hardware a query is resolved
+/// against: a hardware snapshot, or the OpenCL drivers
+///
+static std::uint64_t query_hardware_fingerprint(const std::string& snapshot) {
+  if (snapshot.empty()) {
+    return icd_fingerprint();
+  }
+  fnv1a_hash hash;
+  update_stamps(hash, {snapshot});
+  return hash.value();
+}
+
+flags_cache_entry::flags_cache_entry(const std::string& directory,
+                                     const flags_query& query) {
+  target_selector::scoped_timer timer{"fingerprint query"};
+  fnv1a_hash hash;
+  hash.update(SYCL_INFO_VERSION);
+  hash.update(std::to_string(flags_cache_format));
+  hash.update(query.impl);
+  hash.update(query.config);
+  hash.update(query.target);
+  hash.update(query.all ? "all" : "supported");
+  hash.update(query.hint);
+  hash.update(query.snapshot);
+  hash.update(std::to_string(query_catalog_fingerprint(query.hint)));
+  hash.update(std::to_string(query_hardware_fingerprint(query.snapshot)));
+  path_ = concat_path(directory, path_separator, hash.hex() + ".flags");
+}
+
+// An entry is made of a header line, a line with the sizes of the backend
+// and of the device flags, and the backend and device flags themselves:
+//   sycl-info-flags 1
+//   <backend size> <device flags size>
+//   <backend><device flags>
+bool flags_cache_entry::lookup(backend_info& info) const {
+  target_selector::scoped_timer timer{"read cached flags"};
+  std::ifstream file{path_, std::ios::binary};
+  auto magic = std::string{};
+  auto format = 0;
+  auto backendSize = std::size_t{0};
+  auto flagsSize = std::size_t{0};
+  if (!(file >> magic >> format >> backendSize >> flagsSize) ||
+      magic != "sycl-info-flags" || format != flags_cache_format ||
+      file.get() != '\n') {
+    return false;
+  }
+
+  const auto contents = std::string{std::istreambuf_iterator<char>{file},
+                                    std::istreambuf_iterator<char>{}};
+  if (contents.size() != backendSize + flagsSize) {
+    // Truncated
+    return false;
+  }
+  info.backend = contents.substr(0, backendSize);
+  info.deviceFlags = contents.substr(backendSize);
+  return true;
+}
+
+void flags_cache_entry::store(const backend_info& info) const noexcept {
+#ifdef __unix__
+  try {
+    const auto directory = path_.substr(0, path_.find_last_of(path_separator));
+    mkdir(directory.c_str(), S_IRWXU);
+
+    // Written aside and renamed, so that it is never read partially written
+    const auto temporary = path_ + '.' + std::to_string(getpid());
+    {
+      std::ofstream file{temporary, std::ios::binary};
+      file << "sycl-info-flags " << flags_cache_format << '\n'
+           << info.backend.size() << ' ' << info.deviceFlags.size() << '\n'
+           << info.backend << info.deviceFlags;
+      if (!file.flush()) {
+        std::remove(temporary.c_str());
+        return;
+      }
+    }
+    if (std::rename(temporary.c_str(), path_.c_str()) != 0) {
+      std::remove(temporary.c_str());
+    }
+  } catch (...) {
+  }
+#else
+  static_cast<void>(info);
+#endif
+}
+
+}  // namespace sycl_info
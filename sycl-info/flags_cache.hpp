@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////////
+// flags_cache.hpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SYCL_INFO_FLAGS_CACHE_HPP
+#define SYCL_INFO_FLAGS_CACHE_HPP
+
+#include "impl_matchers.hpp"
+#include <cstdint>
+#include <string>
+
+namespace sycl_info {
+
+/// \brief The directory the device flags are cached in, which is given by
+/// the environment variable SYCL_INFO_CACHE_DIR. POSIX only.
+/// \returns an empty string if the device flags are not cached
+///
+std::string flags_cache_directory();
+
+/// \brief Computes the fingerprint of the OpenCL drivers the ICD loader
+/// sees: the variables that select them, and the paths, identities, sizes
+/// and modification times of their .icd files and of the libraries these
+/// name. The files are queried as one batch (see stat_files()).
+///
+std::uint64_t icd_fingerprint();
+
+/// \brief A query for the device flags of a configuration, as given with
+/// --impl, --config, --target and --device-cflags
+///
+struct flags_query {
+  std::string impl;
+  std::string config;
+  std::string target;
+  bool all = false;
+  std::string hint;
+  /// \brief The hardware snapshot given with --snapshot-in, if any
+  std::string snapshot;
+};
+
+/// \brief The cache entry of a query. It is keyed by the query and by the
+/// fingerprints of the catalog (see catalog_fingerprint()) and of the
+/// hardware it would be resolved against, so that an entry is not found any
+/// more once a .syclinfo file or an OpenCL driver changes.
+///
+/// The fingerprints only need the directories to be listed and the files to
+/// be queried: a cached query parses no .syclinfo file and loads no OpenCL
+/// driver. Devices that are added or removed without any driver changing are
+/// not noticed.
+///
+class flags_cache_entry {
+ public:
+  flags_cache_entry(const std::string& directory, const flags_query& query);
+
+  /// \brief Reads the device flags cached for the query
+  /// \returns false if they are not cached
+  ///
+  bool lookup(backend_info& info) const;
+
+  /// \brief Caches the device flags resolved for the query. Failures are
+  /// ignored: the query is then simply resolved again next time.
+  ///
+  void store(const backend_info& info) const noexcept;
+
+ private:
+  std::string path_;
+};
+
+}  // namespace sycl_info
+
+#endif  // SYCL_INFO_FLAGS_CACHE_HPP
@@ -0,0 +1,283 @@
+////////////////////////////////////////////////////////////////////////////////
+// fleet_inventory.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "fleet_inventory.hpp"
+
+#include "hardware_snapshot.hpp"
+#include "impl_finder.hpp"
+#include "utility.hpp"
+#include <algorithm>
+#include <exception>
+#include <set>
+#include <unordered_map>
+
+namespace sycl_info {
+
+std::string fingerprint(const using_target_matcher::print_type& hardware) {
+  // print_type is ordered, so identical sets are hashed in the same order.
+  // Driver versions are left out: they do not take part in matching.
+  fnv1a_hash hash;
+  for (const auto& plat : hardware) {
+    hash.update(plat.name);
+    hash.update(plat.vendor);
+    hash.update(std::to_string(plat.devices.size()));
+    for (const auto& dev : plat.devices) {
+      hash.update(dev.name);
+      hash.update(dev.vendor);
+      hash.update(dev.type);
+    }
+  }
+  return hash.hex();
+}
+
+/// @brief Compares what fingerprint() hashes, so that two different device
+/// sets are not merged when their fingerprints collide
+///
+static bool same_device_set(const using_target_matcher::print_type& lhs,
+                            const using_target_matcher::print_type& rhs) {
+  auto same_device = [](const using_target_matcher::device& l,
+                        const using_target_matcher::device& r) {
+    return l.name == r.name && l.vendor == r.vendor && l.type == r.type;
+  };
+  auto same_platform = [&](const using_target_matcher::platform& l,
+                           const using_target_matcher::platform& r) {
+    return l.name == r.name && l.vendor == r.vendor &&
+           l.devices.size() == r.devices.size() &&
+           std::equal(l.devices.begin(), l.devices.end(), r.devices.begin(),
+                      same_device);
+  };
+  return lhs.size() == rhs.size() &&
+         std::equal(lhs.begin(), lhs.end(), rhs.begin(), same_platform);
+}
+
+fleet_inventory group_device_sets(std::vector<fleet_node> nodes) {
+  fleet_inventory fleet;
+  fleet.nodes = nodes.size();
+  // The device sets with a given fingerprint: more than one if it collides
+  auto setIndex =
+      std::unordered_map<std::string, std::vector<std::size_t>>{};
+  for (auto& node : nodes) {
+    auto& candidates = setIndex[node.fingerprint];
+    const auto found = std::find_if(
+        candidates.begin(), candidates.end(), [&](std::size_t set) {
+          return same_device_set(fleet.deviceSets[set].hardware,
+                                 node.hardware);
+        });
+    auto set = fleet.deviceSets.size();
+    if (found == candidates.end()) {
+      candidates.push_back(set);
+      fleet.deviceSets.push_back(fleet_device_set{
+          std::move(node.fingerprint), std::move(node.hardware), {}});
+    } else {
+      set = *found;
+    }
+    fleet.deviceSets[set].nodes.push_back(std::move(node.file));
+  }
+
+  auto by_node_count = [](const fleet_device_set& lhs,
+                          const fleet_device_set& rhs) {
+    return lhs.nodes.size() > rhs.nodes.size();
+  };
+  std::stable_sort(fleet.deviceSets.begin(), fleet.deviceSets.end(),
+                   by_node_count);
+  return fleet;
+}
+
+fleet_inventory load_fleet(const std::string& directory) {
+  auto files = list_directory(directory);
+  files.erase(std::remove_if(files.begin(), files.end(),
+                             [](const std::string& file) {
+                               return file.empty() || file.front() == '.';
+                             }),
+              files.end());
+  std::sort(files.begin(), files.end());
+
+  auto nodes = std::vector<fleet_node>(files.size());
+  auto loaded = std::vector<char>(files.size(), false);
+  parallel_for(files.size(), [&](std::size_t i) {
+    try {
+      nodes[i].hardware =
+          load_snapshot(concat_path(directory, path_separator, files[i]));
+      nodes[i].fingerprint = fingerprint(nodes[i].hardware);
+      loaded[i] = true;
+    } catch (std::exception&) {
+      // Reported as skipped below
+    }
+  });
+
+  auto skipped = std::vector<std::string>{};
+  auto loadedNodes = std::vector<fleet_node>{};
+  for (std::size_t i = 0; i < nodes.size(); ++i) {
+    if (loaded[i]) {
+      nodes[i].file = std::move(files[i]);
+      loadedNodes.push_back(std::move(nodes[i]));
+    } else {
+      skipped.push_back(std::move(files[i]));
+    }
+  }
+  auto fleet = group_device_sets(std::move(loadedNodes));
+  fleet.skipped = std::move(skipped);
+  return fleet;
+}
+
+/// @brief Maps the platform/device names of each configuration of an
+/// implementation to the backend targets it supports. As in
+/// match_config_with_impls(), the first matching configuration wins.
+///
+static std::unordered_map<std::string, std::vector<std::string>>
+configuration_backends(const nlohmann::json& impl) {
+  using configs = select<selections::supported_configurations>;
+  using platform = select<selections::plat_name>;
+  using device = select<selections::dev_name>;
+  using supported_backend = select<selections::supported_backend_targets>;
+  using backend = select<selections::backend>;
+
+  auto result = std::unordered_map<std::string, std::vector<std::string>>{};
+  for (const auto& config : impl[configs::value]) {
+    auto backends = std::vector<std::string>{};
+    for (const auto& target : config[supported_backend::value]) {
+      backends.push_back(target[backend::value]);
+    }
+    result.emplace(config[platform::value].get<std::string>() + '\0' +
+                       config[device::value].get<std::string>(),
+                   std::move(backends));
+  }
+  return result;
+}
+
+std::vector<fleet_coverage> match_fleet(
+    const fleet_inventory& fleet, const std::vector<nlohmann::json>& impls) {
+  auto coverage = std::vector<fleet_coverage>{};
+
+  // One row per implementation/backend combination. Each implementation is
+  // converted once, rather than once per device set.
+  auto backends =
+      std::vector<std::unordered_map<std::string, std::vector<std::string>>>{};
+  auto rows = std::vector<std::unordered_map<std::string, std::size_t>>{};
+  auto supported = std::vector<using_target_matcher::print_type>{};
+  auto deviceTypes = std::vector<device_type_map>{};
+  for (const auto& impl : impls) {
+    backends.push_back(configuration_backends(impl));
+    supported.push_back(using_target_matcher::from_json(impl));
+    deviceTypes.push_back(supported_device_types(impl));
+
+    auto names = std::set<std::string>{};
+    for (const auto& config : backends.back()) {
+      names.insert(config.second.begin(), config.second.end());
+    }
+
+    rows.emplace_back();
+    for (const auto& name : names) {
+      rows.back().emplace(name, coverage.size());
+      coverage.push_back(fleet_coverage{
+          impl["name"], name,
+          std::vector<std::size_t>(fleet.deviceSets.size()), 0});
+    }
+  }
+
+  // Each device set only updates its own column, so the sets can be matched
+  // concurrently. An exception thrown by the matching is kept and rethrown
+  // here, as parallel_for() bodies must not throw.
+  auto errors = std::vector<std::exception_ptr>(fleet.deviceSets.size());
+  parallel_for(fleet.deviceSets.size(), [&](std::size_t set) {
+    try {
+      const auto& hardware = fleet.deviceSets[set].hardware;
+      for (std::size_t i = 0; i < impls.size(); ++i) {
+        const auto matched =
+            match_supported(supported[i], deviceTypes[i], &hardware);
+        for (const auto& plat : matched) {
+          for (const auto& dev : plat.devices) {
+            const auto config =
+                backends[i].find(plat.name + '\0' + dev.name);
+            if (config == backends[i].end()) {
+              continue;
+            }
+            for (const auto& backend : config->second) {
+              ++coverage[rows[i].at(backend)].devices[set];
+            }
+          }
+        }
+      }
+    } catch (...) {
+      errors[set] = std::current_exception();
+    }
+  });
+  for (const auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  for (auto& row : coverage) {
+    for (std::size_t set = 0; set < fleet.deviceSets.size(); ++set) {
+      if (row.devices[set] != 0) {
+        row.nodes += fleet.deviceSets[set].nodes.size();
+      }
+    }
+  }
+  return coverage;
+}
+
+void dump_fleet(const fleet_inventory& fleet,
+                const std::vector<fleet_coverage>& coverage,
+                std::ostream& out) {
+  out << "Fleet: " << fleet.nodes << " node(s), " << fleet.deviceSets.size()
+      << " unique device set(s)\n\n";
+
+  out << "Device sets:\n";
+  int setIndex = 1;
+  for (const auto& set : fleet.deviceSets) {
+    auto devices = std::size_t{0};
+    for (const auto& plat : set.hardware) {
+      devices += plat.devices.size();
+    }
+    out << setIndex++ << ". " << set.fingerprint << " | " << set.nodes.size()
+        << " node(s) | " << devices << " device(s) | e.g. "
+        << set.nodes.front() << '\n';
+  }
+
+  out << "\nCoverage (matched devices per device set):\n";
+  for (const auto& row : coverage) {
+    out << row.impl << " | " << row.backend << " |";
+    for (std::size_t set = 0; set < row.devices.size(); ++set) {
+      out << ' ' << (set + 1) << ": " << row.devices[set] << " |";
+    }
+    out << ' ' << row.nodes << '/' << fleet.nodes << " node(s)";
+    if (fleet.nodes != 0 && row.nodes == fleet.nodes) {
+      out << " (whole fleet)";
+    }
+    out << '\n';
+  }
+
+  if (!fleet.skipped.empty()) {
+    out << "\nSkipped " << fleet.skipped.size()
+        << " file(s) that are not hardware snapshots:\n";
+    for (const auto& file : fleet.skipped) {
+      out << "  " << file << '\n';
+    }
+  }
+}
+
+void print_fleet(const std::string& directory,
+                 const std::vector<nlohmann::json>& impls, std::ostream& out) {
+  const auto fleet = load_fleet(directory);
+  dump_fleet(fleet, match_fleet(fleet, impls), out);
+}
+
+}  // namespace sycl_info
@@ -0,0 +1,113 @@
+////////////////////////////////////////////////////////////////////////////////
+// fleet_inventory.hpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SYCL_INFO_FLEET_INVENTORY_HPP
+#define SYCL_INFO_FLEET_INVENTORY_HPP
+
+#include "impl_matchers.hpp"
+#include <cstddef>
+#include <nlohmann/json.hpp>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace sycl_info {
+
+/// @brief A set of platforms/devices shared by one or more nodes of a fleet
+///
+struct fleet_device_set {
+  /// @brief Identifies the platforms/devices of the set
+  std::string fingerprint;
+  using_target_matcher::print_type hardware;
+  /// @brief The snapshot files of the nodes that have this device set
+  std::vector<std::string> nodes;
+};
+
+/// @brief The hardware of a fleet, with identical device sets deduplicated
+///
+struct fleet_inventory {
+  /// @brief The unique device sets, the most common first
+  std::vector<fleet_device_set> deviceSets;
+  /// @brief The number of nodes (snapshot files) that were loaded
+  std::size_t nodes = 0;
+  /// @brief The files of the directory that are not hardware snapshots
+  std::vector<std::string> skipped;
+};
+
+/// @brief How well an implementation/backend combination covers a fleet
+///
+struct fleet_coverage {
+  std::string impl;
+  std::string backend;
+  /// @brief The number of devices matched in each device set, in the same
+  /// order as fleet_inventory::deviceSets
+  std::vector<std::size_t> devices;
+  /// @brief The number of nodes with at least one matched device
+  std::size_t nodes;
+};
+
+/// @brief Computes the fingerprint of a set of platforms/devices. Sets with
+/// the same platforms, devices and device types have the same fingerprint.
+///
+std::string fingerprint(const using_target_matcher::print_type& hardware);
+
+/// @brief A node of a fleet
+///
+struct fleet_node {
+  /// @brief The snapshot file of the node
+  std::string file;
+  /// @brief The fingerprint() of its hardware
+  std::string fingerprint;
+  using_target_matcher::print_type hardware;
+};
+
+/// @brief Deduplicates the identical device sets of the nodes of a fleet.
+/// Nodes are only grouped when their hardware is the same, not merely their
+/// fingerprint, as fingerprints can collide.
+///
+fleet_inventory group_device_sets(std::vector<fleet_node> nodes);
+
+/// @brief Loads every hardware snapshot in a directory in parallel and
+/// deduplicates the identical device sets (see group_device_sets())
+/// @param A path to a directory of hardware snapshots, one per node
+///
+fleet_inventory load_fleet(const std::string& directory);
+
+/// @brief Matches every device set of a fleet with every implementation
+/// @return One entry per implementation/backend combination
+///
+std::vector<fleet_coverage> match_fleet(
+    const fleet_inventory& fleet, const std::vector<nlohmann::json>& impls);
+
+/// @brief Prints the device sets of a fleet and its coverage matrix
+///
+void dump_fleet(const fleet_inventory& fleet,
+                const std::vector<fleet_coverage>& coverage,
+                std::ostream& out);
+
+/// @brief Loads, matches and prints a fleet of hardware snapshots
+/// @param A path to a directory of hardware snapshots, the implementations to
+/// match against and a stream to print to
+///
+void print_fleet(const std::string& directory,
+                 const std::vector<nlohmann::json>& impls, std::ostream& out);
+
+}  // namespace sycl_info
+
+#endif  // SYCL_INFO_FLEET_INVENTORY_HPP
@@ -0,0 +1,144 @@
+////////////////////////////////////////////////////////////////////////////////
+// hardware_snapshot.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "hardware_snapshot.hpp"
+
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include <target_selector/target_selector.hpp>
+
+using json = nlohmann::json;
+
+namespace sycl_info {
+
+using_target_matcher::print_type capture_hardware() {
+  using_target_matcher::print_type hardware;
+  enumerate_devices([&hardware](const using_target_matcher::platform& plat,
+                                const using_target_matcher::device& dev) {
+    auto it = hardware.insert(
+        using_target_matcher::platform{plat.name, plat.vendor, {}});
+    it.first->devices.insert(dev);
+    return true;
+  });
+  return hardware;
+}
+
+// The snapshot is a compact (unindented) json document:
+// {
+//   "snapshot_version": 1,
+//   "platforms": [
+//     {
+//       "platform_name": "...",
+//       "platform_vendor": "...",
+//       "devices": [
+//         { "device_name": "...", "device_vendor": "...",
+//           "device_type": "GPU", "driver_version": "..." },
+//         ...
+//       ]
+//     },
+//     ...
+//   ]
+// }
+void write_snapshot(const using_target_matcher::print_type& hardware,
+                    std::ostream& out) {
+  using plat_name = select<selections::plat_name>;
+  using plat_vendor = select<selections::plat_vendor>;
+  using dev_name = select<selections::dev_name>;
+  using dev_vendor = select<selections::dev_vendor>;
+  using dev_type = select<selections::dev_type>;
+  using version = snapshot_select<snapshot_selections::format_version>;
+  using platforms = snapshot_select<snapshot_selections::platforms>;
+  using devices = snapshot_select<snapshot_selections::devices>;
+  using driver = snapshot_select<snapshot_selections::driver>;
+
+  auto snapshot = json::object();
+  snapshot[version::value] = snapshot_format_version;
+  auto& platformsJson = snapshot[platforms::value] = json::array();
+  for (const auto& plat : hardware) {
+    auto platJson = json::object();
+    platJson[plat_name::value] = plat.name;
+    platJson[plat_vendor::value] = plat.vendor;
+    auto& devicesJson = platJson[devices::value] = json::array();
+    for (const auto& dev : plat.devices) {
+      auto devJson = json::object();
+      devJson[dev_name::value] = dev.name;
+      devJson[dev_vendor::value] = dev.vendor;
+      devJson[dev_type::value] = dev.type;
+      devJson[driver::value] = dev.driverVersion;
+      devicesJson.push_back(std::move(devJson));
+    }
+    platformsJson.push_back(std::move(platJson));
+  }
+
+  out << snapshot.dump() << '\n';
+}
+
+using_target_matcher::print_type read_snapshot(std::istream& in) {
+  using plat_name = select<selections::plat_name>;
+  using plat_vendor = select<selections::plat_vendor>;
+  using dev_name = select<selections::dev_name>;
+  using dev_vendor = select<selections::dev_vendor>;
+  using dev_type = select<selections::dev_type>;
+  using version = snapshot_select<snapshot_selections::format_version>;
+  using platforms = snapshot_select<snapshot_selections::platforms>;
+  using devices = snapshot_select<snapshot_selections::devices>;
+  using driver = snapshot_select<snapshot_selections::driver>;
+
+  const auto snapshot = json::parse(in, nullptr, false);
+  if (!snapshot.is_object() ||
+      snapshot.value(version::value, 0) != snapshot_format_version) {
+    throw target_selector::sycl_info_error{
+        "Not a hardware snapshot of version " +
+        std::to_string(snapshot_format_version)};
+  }
+
+  using_target_matcher::print_type hardware;
+  for (const auto& platJson : snapshot.at(platforms::value)) {
+    auto plat = hardware.insert(using_target_matcher::platform{
+        platJson.at(plat_name::value), platJson.at(plat_vendor::value), {}});
+    for (const auto& devJson : platJson.at(devices::value)) {
+      using_target_matcher::device dev;
+      dev.name = devJson.at(dev_name::value);
+      dev.vendor = devJson.at(dev_vendor::value);
+      dev.type = devJson.value(dev_type::value, std::string{});
+      dev.driverVersion = devJson.value(driver::value, std::string{});
+      plat.first->devices.insert(std::move(dev));
+    }
+  }
+  return hardware;
+}
+
+void save_snapshot(const std::string& path) {
+  std::ofstream file{path};
+  if (!file) {
+    throw target_selector::sycl_info_error{"Unable to write snapshot " + path};
+  }
+  write_snapshot(capture_hardware(), file);
+}
+
+using_target_matcher::print_type load_snapshot(const std::string& path) {
+  target_selector::scoped_timer timer{"load snapshot"};
+  std::ifstream file{path};
+  if (!file) {
+    throw target_selector::sycl_info_error{"Unable to read snapshot " + path};
+  }
+  return read_snapshot(file);
+}
+
+}  // namespace sycl_info
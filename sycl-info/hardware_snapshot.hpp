@@ -0,0 +1,108 @@
+////////////////////////////////////////////////////////////////////////////////
+// hardware_snapshot.hpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SYCL_INFO_HARDWARE_SNAPSHOT_HPP
+#define SYCL_INFO_HARDWARE_SNAPSHOT_HPP
+
+#include "impl_matchers.hpp"
+#include <iosfwd>
+#include <string>
+
+namespace sycl_info {
+
+/// @brief The version of the hardware snapshot format written by sycl-info.
+/// Snapshots with a different version are rejected when they are read.
+///
+constexpr int snapshot_format_version = 1;
+
+/// @brief Enumerates every platform/device available on the system,
+/// regardless of whether they support SPIR
+/// @return The hardware in its print representation, including the device
+/// properties
+///
+using_target_matcher::print_type capture_hardware();
+
+/// @brief Serializes hardware to a stream in the snapshot format
+/// @param The hardware to serialize and a stream to write to
+///
+void write_snapshot(const using_target_matcher::print_type& hardware,
+                    std::ostream& out);
+
+/// @brief Deserializes hardware from a stream in the snapshot format
+/// @param A stream to read from
+/// @return The hardware stored in the snapshot
+/// @throws target_selector::sycl_info_error if the stream does not hold a
+/// snapshot of a supported version
+///
+using_target_matcher::print_type read_snapshot(std::istream& in);
+
+/// @brief Captures the system's hardware and writes it to the file at path
+/// @throws target_selector::sycl_info_error if the file cannot be written
+///
+void save_snapshot(const std::string& path);
+
+/// @brief Reads the hardware stored in the snapshot file at path
+/// @throws target_selector::sycl_info_error if the file cannot be read or
+/// does not hold a snapshot of a supported version
+///
+using_target_matcher::print_type load_snapshot(const std::string& path);
+
+/// @brief Enum that represents the name of a field in a snapshot file that is
+/// not shared with the syclinfo files.
+///
+enum class snapshot_selections { format_version, platforms, devices, driver };
+
+/// @brief Generic template that maps a field in the enum snapshot_selections
+/// to its name in the snapshot file. The unspecialized base template is left
+/// undefined.
+///
+template <snapshot_selections T>
+struct snapshot_select;
+
+/// @brief Specialization for snapshot_selections::format_version
+///
+template <>
+struct snapshot_select<snapshot_selections::format_version> {
+  static constexpr const char* value = "snapshot_version";
+};
+
+/// @brief Specialization for snapshot_selections::platforms
+///
+template <>
+struct snapshot_select<snapshot_selections::platforms> {
+  static constexpr const char* value = "platforms";
+};
+
+/// @brief Specialization for snapshot_selections::devices
+///
+template <>
+struct snapshot_select<snapshot_selections::devices> {
+  static constexpr const char* value = "devices";
+};
+
+/// @brief Specialization for snapshot_selections::driver
+///
+template <>
+struct snapshot_select<snapshot_selections::driver> {
+  static constexpr const char* value = "driver_version";
+};
+
+}  // namespace sycl_info
+
+#endif  // SYCL_INFO_HARDWARE_SNAPSHOT_HPP
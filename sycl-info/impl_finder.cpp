@@ -18,9 +18,22 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include "impl_finder.hpp"
+#include "catalog_parser.hpp"
+#include "embedded_catalog.hpp"
+#include "shared_catalog.hpp"
+#include "utility.hpp"
 #include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <istream>
+#include <iterator>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <streambuf>
 #include <nlohmann/json.hpp>
 #include <target_selector/target_selector.hpp>
 
@@ -32,6 +45,10 @@ using json = nlohmann::json;
 #include <windows.h>
 #elif __unix__
 #include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 #else
 #error "Not a windows/POSIX environment"
 #endif
@@ -43,11 +60,12 @@ bool is_sycl_env_set() {
 }
 
 void cache_path(std::vector<json>& cache, const std::string& path) {
-  std::ifstream file{path};
+  target_selector::scoped_timer timer{"parse .syclinfo"};
+  std::ifstream file{path, std::ios::binary};
   if (file) {
-    json j;
-    file >> j;
-    cache.push_back(std::move(j));
+    const auto contents = std::string{std::istreambuf_iterator<char>{file},
+                                      std::istreambuf_iterator<char>{}};
+    cache.push_back(parse_catalog_file(contents));
   }
 }
 
@@ -67,61 +85,422 @@ std::string concat_path(const std::string& path, char separator,
 }
 
 bool ends_with_sycl(const std::string& file) {
-  const auto extension = std::string{".syclinfo"};
-  return ends_with_suffix(file, extension);
+  return ends_with_sycl(file.data(), file.size());
+}
+
+bool ends_with_sycl(const char* file, const std::size_t length) noexcept {
+  static constexpr char extension[] = ".syclinfo";
+  constexpr auto size = sizeof(extension) - 1;
+  return length >= size &&
+         std::memcmp(file + length - size, extension, size) == 0;
+}
+
+bool matches_pattern(const char* name, const char* pattern) noexcept {
+  // On a mismatch, the last '*' is retried one character further
+  const char* star = nullptr;
+  const char* retry = nullptr;
+  while (*name) {
+    if (*pattern == '*') {
+      star = pattern++;
+      retry = name;
+    } else if (*pattern == '?' || *pattern == *name) {
+      ++pattern;
+      ++name;
+    } else if (star) {
+      pattern = star + 1;
+      name = ++retry;
+    } else {
+      return false;
+    }
+  }
+  while (*pattern == '*') {
+    ++pattern;
+  }
+  return *pattern == '\0';
+}
+
+namespace {
+std::mutex searchOptionsMutex;
+search_options searchOptions;
+}  // namespace
+
+void set_search_options(search_options options) {
+  std::lock_guard<std::mutex> lock{searchOptionsMutex};
+  searchOptions = std::move(options);
+}
+
+search_options get_search_options() {
+  std::lock_guard<std::mutex> lock{searchOptionsMutex};
+  return searchOptions;
+}
+
+/// \brief Checks if a subdirectory is left out of a search
+///
+static bool is_pruned(const search_options& options, const char* name) {
+  return std::any_of(options.prune.begin(), options.prune.end(),
+                     [name](const std::string& pattern) {
+                       return matches_pattern(name, pattern.c_str());
+                     });
+}
+
+/// \brief Checks if a name is "." or ".."
+///
+static bool is_dot_entry(const char* name) noexcept {
+  return name[0] == '.' &&
+         (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
 }
 
 #ifdef __linux__
-std::vector<json> find_sycl_impls(const std::vector<std::string>& paths) {
-  auto cache = std::vector<json>{};
-  const char separator = '/';
-  for (const auto& path : paths) {
-    auto customDeleter = [](DIR* ptr) { closedir(ptr); };
-    auto dirDesc = std::unique_ptr<DIR, decltype(customDeleter)>(
-        opendir(path.c_str()), customDeleter);
-    struct dirent* dir;
-
-    if (dirDesc) {
-      while ((dir = readdir(dirDesc.get()))) {
-        const auto file = std::string{dir->d_name};
-        if (ends_with_sycl(file)) {
-          cache_path(cache, concat_path(path, separator, file));
+std::vector<std::string> list_directory(const std::string& path) {
+  target_selector::scoped_timer timer{"readdir"};
+  auto files = std::vector<std::string>{};
+  auto customDeleter = [](DIR* ptr) { closedir(ptr); };
+  auto dirDesc = std::unique_ptr<DIR, decltype(customDeleter)>(
+      opendir(path.c_str()), customDeleter);
+  struct dirent* dir;
+
+  if (dirDesc) {
+    while ((dir = readdir(dirDesc.get()))) {
+      files.emplace_back(dir->d_name);
+    }
+  }
+  return files;
+}
+
+namespace {
+/// \brief Closes a file descriptor when it goes out of scope
+///
+class scoped_descriptor {
+ public:
+  explicit scoped_descriptor(int fd) noexcept : fd_(fd) {}
+  ~scoped_descriptor() {
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+  }
+
+  scoped_descriptor(const scoped_descriptor&) = delete;
+  scoped_descriptor& operator=(const scoped_descriptor&) = delete;
+
+  int get() const noexcept { return fd_; }
+
+ private:
+  int fd_;
+};
+
+/// \brief Searches a tree of directories with getdents64, which gives the
+/// type of each entry with its name, a large buffer of entries at a time
+///
+class syclinfo_search {
+ public:
+  syclinfo_search(const search_options& options,
+                  std::vector<std::string>& files)
+      : options_(options), files_(files), buffer_(65536) {}
+
+  void search(const int directory, const std::string& path,
+              const unsigned int depth) {
+    if (options_.depth > 0) {
+      // A symlink to a parent directory would otherwise be searched until
+      // the depth limit
+      struct stat info;
+      if (fstat(directory, &info) != 0 ||
+          !visited_
+               .emplace(static_cast<std::uint64_t>(info.st_dev),
+                        static_cast<std::uint64_t>(info.st_ino))
+               .second) {
+        return;
+      }
+    }
+
+    auto subdirectories = std::vector<std::string>{};
+    for (;;) {
+      const auto size = syscall(SYS_getdents64, directory, buffer_.data(),
+                                buffer_.size());
+      if (size <= 0) {
+        break;
+      }
+      for (long offset = 0; offset < size;) {
+        const auto* entry =
+            reinterpret_cast<const struct dirent64*>(&buffer_[offset]);
+        offset += entry->d_reclen;
+        const char* name = entry->d_name;
+        if (is_dot_entry(name)) {
+          continue;
+        }
+        const auto length = std::strlen(name);
+        auto type = entry->d_type;
+        if (type != DT_DIR && ends_with_sycl(name, length)) {
+          files_.push_back(concat_path(path, path_separator, name));
+          continue;
+        }
+        if (depth >= options_.depth || is_pruned(options_, name)) {
+          continue;
+        }
+        // Only symlinks, and filesystems that do not fill d_type in, need
+        // to be queried
+        if (type == DT_LNK || type == DT_UNKNOWN) {
+          struct stat info;
+          if (fstatat(directory, name, &info, 0) == 0 &&
+              S_ISDIR(info.st_mode)) {
+            type = DT_DIR;
+          }
+        }
+        if (type == DT_DIR) {
+          subdirectories.emplace_back(name, length);
         }
       }
     }
+
+    for (const auto& name : subdirectories) {
+      const scoped_descriptor subdirectory{
+          openat(directory, name.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)};
+      if (subdirectory.get() >= 0) {
+        search(subdirectory.get(), concat_path(path, path_separator, name),
+               depth + 1);
+      }
+    }
   }
-  return cache;
+
+ private:
+  const search_options& options_;
+  std::vector<std::string>& files_;
+  std::vector<char> buffer_;
+  std::set<file_identity> visited_;
+};
+}  // namespace
+
+bool find_syclinfo_files(const std::string& path,
+                         const search_options& options,
+                         std::vector<std::string>& files) {
+  target_selector::scoped_timer timer{"readdir"};
+  const scoped_descriptor directory{
+      open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)};
+  if (directory.get() < 0) {
+    return false;
+  }
+  syclinfo_search{options, files}.search(directory.get(), path, 0);
+  return true;
 }
 #endif  //__linux__
 
 #ifdef _WIN32
-std::vector<json> find_sycl_impls(const std::vector<std::string>& paths) {
+std::vector<std::string> list_directory(const std::string& path) {
+  target_selector::scoped_timer timer{"readdir"};
+  auto files = std::vector<std::string>{};
+  WIN32_FIND_DATA data;
+
+  // Find all the files in the directory
+  auto customDeleter = [](HANDLE ptr) { FindClose(ptr); };
+
+  // HANDLE is a typedef for PVOID which in respect is a typedef of void*
+  // Therefore to access the type we need std::remove_pointer
+  auto hFind = std::unique_ptr<std::remove_pointer<HANDLE>::type,
+                               decltype(customDeleter)>(
+      FindFirstFileA((path + "\\*").c_str(), &data), customDeleter);
+
+  if (hFind.get() != INVALID_HANDLE_VALUE) {
+    do {
+      files.emplace_back(data.cFileName);
+    } while (FindNextFile(hFind.get(), &data) != 0);
+  }
+  return files;
+}
+
+/// \brief Searches a directory and its subdirectories, which are told apart
+/// by the attributes FindFirstFile/FindNextFile give with each name
+///
+static bool search_directory(const std::string& path,
+                             const search_options& options,
+                             const unsigned int depth,
+                             std::vector<std::string>& files) {
+  WIN32_FIND_DATAA data;
+  auto customDeleter = [](HANDLE ptr) { FindClose(ptr); };
+  auto hFind = std::unique_ptr<std::remove_pointer<HANDLE>::type,
+                               decltype(customDeleter)>(
+      FindFirstFileA((path + "\\*").c_str(), &data), customDeleter);
+  if (hFind.get() == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  auto subdirectories = std::vector<std::string>{};
+  do {
+    const char* name = data.cFileName;
+    if (is_dot_entry(name)) {
+      continue;
+    }
+    const auto attributes = data.dwFileAttributes;
+    if (!(attributes & FILE_ATTRIBUTE_DIRECTORY)) {
+      if (ends_with_sycl(name, std::strlen(name))) {
+        files.push_back(concat_path(path, path_separator, name));
+      }
+    } else if (depth < options.depth &&
+               // Junctions could lead back to a parent directory
+               !(attributes & FILE_ATTRIBUTE_REPARSE_POINT) &&
+               !is_pruned(options, name)) {
+      subdirectories.emplace_back(name);
+    }
+  } while (FindNextFileA(hFind.get(), &data) != 0);
+
+  for (const auto& name : subdirectories) {
+    search_directory(concat_path(path, path_separator, name), options,
+                     depth + 1, files);
+  }
+  return true;
+}
+
+bool find_syclinfo_files(const std::string& path,
+                         const search_options& options,
+                         std::vector<std::string>& files) {
+  target_selector::scoped_timer timer{"readdir"};
+  return search_directory(path, options, 0, files);
+}
+#endif  //_WIN32
+
+impl_discovery::impl_discovery(std::vector<std::string> paths,
+                               search_options options)
+    : paths_(std::move(paths)),
+      options_(std::move(options)),
+      searched_(false),
+      prefetched_(false),
+      fileIndex_(0),
+      hash_(0) {}
+
+const std::vector<std::string>& impl_discovery::candidates() {
+  if (!searched_) {
+    for (auto& files : search_directories(paths_, options_)) {
+      std::move(files.begin(), files.end(), std::back_inserter(candidates_));
+    }
+    searched_ = true;
+  }
+  return candidates_;
+}
+
+void impl_discovery::prefetch() {
+  // Walking the files one at a time pays a round trip per request on a
+  // network filesystem: every directory is searched, and every file read, in
+  // one go instead
+  files_ = read_files(candidates());
+  prefetched_ = true;
+}
+
+void impl_discovery::add_source(std::size_t index) {
+  // The same directory may be searched twice (e.g. SYCL_VENDOR_PATHS and
+  // --hint), which walks the same path twice
+  auto& paths = sources_[index];
+  if (std::find(paths.begin(), paths.end(), current_) == paths.end()) {
+    paths.push_back(current_);
+  }
+}
+
+std::size_t impl_discovery::find_same_contents() const {
+  const auto& contents = files_[fileIndex_ - 1].contents;
+  const auto candidates = hashes_.equal_range(hash_);
+  for (auto it = candidates.first; it != candidates.second; ++it) {
+    if (files_[walked_[it->second]].contents == contents) {
+      return it->second;
+    }
+  }
+  return sources_.size();
+}
+
+bool impl_discovery::next() {
+  if (!prefetched_) {
+    prefetch();
+  }
+  while (fileIndex_ < files_.size()) {
+    const auto& file = files_[fileIndex_++];
+    if (!file.read) {
+      continue;
+    }
+    current_ = file.path;
+    const auto walked = file.identified ? identities_.find(file.identity)
+                                        : identities_.end();
+    if (walked != identities_.end()) {
+      add_source(walked->second);
+      continue;
+    }
+
+    fnv1a_hash hash;
+    hash.update(file.contents.data(), file.contents.size());
+    hash_ = hash.value();
+    const auto same = find_same_contents();
+    if (file.identified) {
+      identities_.emplace(file.identity, same);
+    }
+    if (same != sources_.size()) {
+      add_source(same);
+      continue;
+    }
+    hashes_.emplace(hash_, sources_.size());
+    walked_.push_back(fileIndex_ - 1);
+    sources_.push_back(std::vector<std::string>{current_});
+    return true;
+  }
+  current_.clear();
+  return false;
+}
+
+json impl_discovery::load() { return load(walked_.size() - 1); }
+
+json impl_discovery::load(std::size_t index) {
+  target_selector::scoped_timer timer{"parse .syclinfo"};
+  return parse_catalog_file(files_[walked_[index]].contents);
+}
+
+/// \brief Loads every distinct file of a walk
+///
+static std::vector<json> load_all(impl_discovery& discovery) {
   auto cache = std::vector<json>{};
-  const char separator = '\\';
-  for (const auto& path : paths) {
-    WIN32_FIND_DATA data;
-
-    // Find all files with a given extension
-    auto customDeleter = [](HANDLE ptr) { FindClose(ptr); };
-
-    // HANDLE is a typedef for PVOID which in respect is a typedef of void*
-    // Therefore to access the type we need std::remove_pointer
-    auto hFind = std::unique_ptr<std::remove_pointer<HANDLE>::type,
-                                 decltype(customDeleter)>(
-        FindFirstFileA((path + "\\*").c_str(), &data), customDeleter);
-
-    if (hFind.get() != INVALID_HANDLE_VALUE) {
-      do {
-        const auto file = std::string{data.cFileName};
-        if (ends_with_sycl(file)) {
-          cache_path(cache, concat_path(path, separator, file));
-        }
-      } while (FindNextFile(hFind.get(), &data) != 0);
+  while (discovery.next()) {
+    cache.push_back(discovery.load());
+  }
+  // Duplicates can be found after the file they duplicate has been loaded
+  for (std::size_t i = 0; i < cache.size(); ++i) {
+    if (cache[i].is_object()) {
+      cache[i]["source_paths"] = discovery.sources(i);
     }
   }
   return cache;
 }
-#endif  //_WIN32
+
+/// \brief Attaches to the shared catalog of the directories of a walk. When
+/// there is none, either the right to publish it is claimed, or the process
+/// that claimed it first is waited for.
+///
+static std::unique_ptr<shared_catalog> attach_shared_catalog(
+    impl_discovery& discovery, std::uint64_t fingerprint,
+    std::unique_ptr<shared_catalog_writer>& writer) {
+  const auto& paths = discovery.paths();
+  const auto& options = discovery.options();
+  auto shared = shared_catalog::attach(paths, options, fingerprint);
+  if (!shared) {
+    writer = shared_catalog_writer::claim(paths, options);
+    if (!writer) {
+      constexpr bool wait = true;
+      shared = shared_catalog::attach(paths, options, fingerprint, wait);
+    }
+  }
+  return shared;
+}
+
+std::vector<json> find_sycl_impls(const std::vector<std::string>& paths) {
+  impl_discovery discovery{paths};
+  if (!shared_catalog_enabled()) {
+    return load_all(discovery);
+  }
+
+  const auto fingerprint = catalog_fingerprint(discovery.candidates());
+  auto writer = std::unique_ptr<shared_catalog_writer>{};
+  const auto shared = attach_shared_catalog(discovery, fingerprint, writer);
+  if (shared) {
+    return shared->load_all();
+  }
+  auto impls = load_all(discovery);
+  if (writer) {
+    writer->publish(fingerprint, impls);
+  }
+  return impls;
+}
 
 void dump_impls(const std::vector<json>& implementations, std::ostream& out) {
   if (implementations.empty()) {
@@ -144,7 +523,7 @@ std::string get_sycl_vendors_from_environment_var() {
   return target_selector::getenv_variable("SYCL_VENDOR_PATHS");
 }
 
-std::vector<json> get_impls(std::string hint) {
+std::vector<std::string> get_vendor_paths(std::string hint) {
   std::vector<std::string> paths{};
   if (is_sycl_env_set()) {
     const char semicolon = ';';
@@ -165,13 +544,202 @@ std::vector<json> get_impls(std::string hint) {
   if (!hint.empty()) {
     paths.push_back(std::move(hint));
   }
+  return paths;
+}
+
+std::vector<json> get_impls(std::string hint) {
+  const auto paths = get_vendor_paths(std::move(hint));
 
+  // The implementations compiled into sycl-info, if any, need no file I/O;
+  // the files found at runtime are merged on top of them
+  auto impls = embedded_impls();
   if (!paths.empty()) {
-    return find_sycl_impls(paths);
+    merge_impls(impls, find_sycl_impls(paths));
+  }
+  return impls;
+}
+
+/// \brief Lower-cases a string and drops everything but letters and digits,
+/// so that "ComputeCpp CE" can be compared with "computecpp-ce"
+///
+static std::string normalized(const std::string& str) {
+  auto result = std::string{};
+  for (const auto c : str) {
+    if (std::isalnum(static_cast<unsigned char>(c))) {
+      result += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+  }
+  return result;
+}
 
-  } else {
-    return std::vector<json>{};
+/// \brief Reads a request made only of digits as an index. An index too
+/// large to be represented is read as 0, which no implementation has.
+/// \returns false if the request is a name
+///
+static bool read_index(const std::string& requested, unsigned long& index) {
+  if (requested.empty() ||
+      !std::all_of(requested.begin(), requested.end(), [](const char c) {
+        return std::isdigit(static_cast<unsigned char>(c));
+      })) {
+    return false;
+  }
+  try {
+    index = std::stoul(requested);
+  } catch (std::out_of_range&) {
+    index = 0;
+  }
+  return true;
+}
+
+unsigned int find_impl_index(const std::string& requested,
+                             const std::vector<json>& impls) {
+  auto index = 0ul;
+  if (read_index(requested, index)) {
+    return (1 <= index && index <= impls.size())
+               ? static_cast<unsigned int>(index)
+               : 0;
+  }
+  for (std::size_t i = 0; i < impls.size(); ++i) {
+    if (impls[i]["name"] == requested) {
+      return static_cast<unsigned int>(i + 1);
+    }
+  }
+  return 0;
+}
+
+/// \brief Looks an implementation up in a list that has already been loaded
+///
+static impl_lookup find_loaded_impl(const std::string& requested,
+                                    std::vector<json> impls) {
+  const auto index = find_impl_index(requested, impls);
+  if (index == 0) {
+    return {false, 0, json{}};
+  }
+  return {true, index, std::move(impls[index - 1])};
+}
+
+/// \brief Looks an implementation up in a shared catalog, only decoding the
+/// one requested
+///
+static impl_lookup find_shared_impl(const std::string& requested,
+                                    const shared_catalog& shared) {
+  auto index = 0ul;
+  if (read_index(requested, index)) {
+    if (1 <= index && index <= shared.size()) {
+      return {true, static_cast<unsigned int>(index), shared.load(index - 1)};
+    }
+    return {false, 0, json{}};
+  }
+  for (std::size_t i = 0; i < shared.size(); ++i) {
+    if (shared.has_name(i, requested)) {
+      return {true, static_cast<unsigned int>(i + 1), shared.load(i)};
+    }
+  }
+  return {false, 0, json{}};
+}
+
+/// \brief Completes a lookup made while walking: the files after the one
+/// found are walked too, without being parsed, so that it is given all its
+/// paths, as in a full listing
+///
+static impl_lookup found_impl(impl_discovery& discovery, std::size_t index,
+                              json impl) {
+  while (discovery.next()) {
+  }
+  if (impl.is_object()) {
+    impl["source_paths"] = discovery.sources(index);
+  }
+  return {true, static_cast<unsigned int>(index + 1), std::move(impl)};
+}
+
+impl_lookup find_impl(const std::string& requested, std::string hint) {
+  const auto paths = get_vendor_paths(std::move(hint));
+  auto embedded = embedded_impls();
+  if (paths.empty() || !embedded.empty()) {
+    // Files found at runtime can replace embedded implementations, which
+    // moves the indices of the files after them: only a full list resolves
+    // the request then
+    if (!paths.empty()) {
+      merge_impls(embedded, find_sycl_impls(paths));
+    }
+    return find_loaded_impl(requested, std::move(embedded));
+  }
+
+  impl_discovery discovery{paths};
+  if (shared_catalog_enabled()) {
+    const auto fingerprint = catalog_fingerprint(discovery.candidates());
+    auto writer = std::unique_ptr<shared_catalog_writer>{};
+    const auto shared = attach_shared_catalog(discovery, fingerprint, writer);
+    if (shared) {
+      return find_shared_impl(requested, *shared);
+    }
+    // Only a whole catalog can be published
+    auto impls = load_all(discovery);
+    if (writer) {
+      writer->publish(fingerprint, impls);
+    }
+    return find_loaded_impl(requested, std::move(impls));
+  }
+
+  auto index = 0ul;
+  if (read_index(requested, index)) {
+    // Identity-only pass: only the requested file is parsed
+    for (unsigned long i = 1; i <= index && discovery.next(); ++i) {
+      if (i == index) {
+        return found_impl(discovery, i - 1, discovery.load());
+      }
+    }
+    return {false, 0, json{}};
+  }
+
+  // The files are listed first, so that their indices are known. The files
+  // named after the requested name are parsed first, then the ones whose
+  // name contains it, then the others. Whichever matches first is only a
+  // candidate: as in a full listing, a file listed before it with the same
+  // name takes precedence, so only those are parsed to end the search.
+  auto files = std::vector<std::string>{};
+  while (discovery.next()) {
+    files.push_back(discovery.path());
+  }
+  const auto wanted = normalized(requested);
+  const auto extension = std::string{".syclinfo"}.size();
+  auto order = std::vector<std::size_t>{};
+  auto partial = std::vector<std::size_t>{};
+  auto others = std::vector<std::size_t>{};
+  for (std::size_t i = 0; i < files.size(); ++i) {
+    const auto first = files[i].find_last_of(path_separator) + 1;
+    const auto stem = normalized(
+        files[i].substr(first, files[i].size() - first - extension));
+    if (stem == wanted) {
+      order.push_back(i);
+    } else if (stem.find(wanted) != std::string::npos) {
+      partial.push_back(i);
+    } else {
+      others.push_back(i);
+    }
+  }
+  order.insert(order.end(), partial.begin(), partial.end());
+  order.insert(order.end(), others.begin(), others.end());
+
+  auto parsed = std::vector<bool>(files.size(), false);
+  for (const auto i : order) {
+    auto impl = discovery.load(i);
+    parsed[i] = true;
+    if (impl["name"] != requested) {
+      continue;
+    }
+    for (std::size_t earlier = 0; earlier < i; ++earlier) {
+      if (parsed[earlier]) {
+        continue;
+      }
+      auto first = discovery.load(earlier);
+      if (first["name"] == requested) {
+        return found_impl(discovery, earlier, std::move(first));
+      }
+    }
+    return found_impl(discovery, i, std::move(impl));
   }
+  return {false, 0, json{}};
 }
 
 void print_impls(std::ostream& out, std::string hint) {
@@ -20,12 +20,17 @@
 #ifndef SYCL_INFO_IMP_FINDER_H
 #define SYCL_INFO_IMP_FINDER_H
 
+#include "batched_io.hpp"
 #include "impl_matchers.hpp"
 #include <CL/opencl.h>
 #include <algorithm>
-#include <fstream>
+#include <cstddef>
+#include <cstdint>
+#include <map>
 #include <nlohmann/json.hpp>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace sycl_info {
@@ -54,6 +59,45 @@ bool ends_with_suffix(const std::string& str, const std::string& suffix);
 ///
 bool ends_with_sycl(const std::string& file);
 
+/// \brief Checks if a file name ends with ".syclinfo" without copying it
+/// \param a file name and its length
+///
+bool ends_with_sycl(const char* file, std::size_t length) noexcept;
+
+/// \brief Checks if a name matches a pattern in which '*' matches any
+/// sequence of characters and '?' any single character
+///
+bool matches_pattern(const char* name, const char* pattern) noexcept;
+
+/// \brief How the directories are searched for .syclinfo files
+///
+struct search_options {
+  /// \brief How many levels of subdirectories are searched as well (e.g. 3
+  /// for <prefix>/share/sycl/<impl>/ from <prefix>); 0 only searches the
+  /// directories themselves
+  unsigned int depth = 0;
+  /// \brief The names of the subdirectories that are not searched, as
+  /// patterns for matches_pattern()
+  std::vector<std::string> prune;
+};
+
+/// \brief Sets how the directories are searched by the functions that do
+/// not take search_options, e.g. get_impls()
+///
+void set_search_options(search_options options);
+
+/// \brief Retrieves the options set by set_search_options()
+///
+search_options get_search_options();
+
+/// \brief The platform dependent separator used to construct paths
+///
+#ifdef _WIN32
+constexpr char path_separator = '\\';
+#else
+constexpr char path_separator = '/';
+#endif
+
 /// \brief Constructs the full path given a folder, a platform depedent
 /// separator and a file name
 /// \param a path to a folder, a target separator (e.g. "/" for linux) and
@@ -63,8 +107,126 @@ bool ends_with_sycl(const std::string& file);
 std::string concat_path(const std::string& path, char separator,
                         const std::string& file);
 
-/// \brief Linux/Windows implementation for finding .sycl files
-/// \param
+/// \brief Linux/Windows implementation for listing the entries of a directory
+/// \param a path to a directory
+/// \returns the names of the entries in the directory, or an empty vector if
+/// the directory cannot be opened
+///
+std::vector<std::string> list_directory(const std::string& path);
+
+/// \brief Linux/Windows implementation for finding the .syclinfo files of a
+/// directory and, down to the depth of the options, of its subdirectories.
+/// The files of a directory are found before those of its subdirectories.
+/// Entries are classified by the type the directory listing gives them: only
+/// symlinks and entries of unknown type are queried, and only when they may
+/// be subdirectories to search.
+/// \param a path to a directory, how to search it and the list to append the
+/// paths of the files found to
+/// \returns false if the directory cannot be opened
+///
+bool find_syclinfo_files(const std::string& path,
+                         const search_options& options,
+                         std::vector<std::string>& files);
+
+/// \brief Walks the .syclinfo files of a list of directories, in the order in
+/// which sycl-info lists the implementations. The directories are searched,
+/// and their .syclinfo files read, as one batch when the walk starts (see
+/// search_directories() and read_files()), but a file is only parsed when
+/// load() is called, so that a lookup can stop as soon as it has found what
+/// it is looking for.
+///
+/// Overlapping directories (e.g. an install prefix in SYCL_VENDOR_PATHS and a
+/// symlinked copy of it given as --hint) list the same implementation more
+/// than once. A file already walked through another path, or whose contents
+/// are identical to those of a file already walked, is skipped before it is
+/// parsed, and its path is recorded as another source of the first one.
+///
+class impl_discovery {
+ public:
+  explicit impl_discovery(std::vector<std::string> paths,
+                          search_options options = get_search_options());
+
+  /// \brief The paths of the .syclinfo files found in the directories,
+  /// duplicates included. The directories are searched on the first call,
+  /// without reading the files.
+  ///
+  const std::vector<std::string>& candidates();
+
+  /// \brief The directories walked
+  ///
+  const std::vector<std::string>& paths() const noexcept { return paths_; }
+
+  /// \brief How the directories are searched
+  ///
+  const search_options& options() const noexcept { return options_; }
+
+  /// \brief Moves to the next distinct .syclinfo file that can be read;
+  /// files that cannot be read are skipped, as they are not listed either
+  /// \returns false once every directory has been walked
+  ///
+  bool next();
+
+  /// \brief The path of the current file
+  ///
+  const std::string& path() const noexcept { return current_; }
+
+  /// \brief The FNV-1a hash of the contents of the current file
+  ///
+  std::uint64_t content_hash() const noexcept { return hash_; }
+
+  /// \brief Parses the current file
+  /// \returns the json representation of the implementation it describes
+  ///
+  nlohmann::json load();
+
+  /// \brief Parses the index-th file walked (from 0)
+  ///
+  nlohmann::json load(std::size_t index);
+
+  /// \brief The paths of the index-th file walked (from 0), the first one
+  /// being the path it was walked through. Only duplicates walked so far are
+  /// included.
+  ///
+  const std::vector<std::string>& sources(std::size_t index) const {
+    return sources_[index];
+  }
+
+ private:
+  /// \brief Reads the .syclinfo files of the directories
+  ///
+  void prefetch();
+
+  /// \brief Records the current path as a source of the index-th file
+  ///
+  void add_source(std::size_t index);
+
+  /// \brief Finds an earlier file with the same contents as the current one
+  /// \returns Its index, or the number of files walked if there is none
+  ///
+  std::size_t find_same_contents() const;
+
+  std::vector<std::string> paths_;
+  search_options options_;
+  bool searched_;
+  std::vector<std::string> candidates_;
+  bool prefetched_;
+  std::vector<batched_file> files_;
+  /// \brief The position in files_ of the file after the current one
+  std::size_t fileIndex_;
+  std::string current_;
+  std::uint64_t hash_;
+  /// \brief The position in files_ of each file walked
+  std::vector<std::size_t> walked_;
+  /// \brief The index of the file each identity was walked as
+  std::map<file_identity, std::size_t> identities_;
+  std::unordered_multimap<std::uint64_t, std::size_t> hashes_;
+  std::vector<std::vector<std::string>> sources_;
+};
+
+/// \brief Finds the .syclinfo files of a list of directories. A file found
+/// more than once, or with the same contents as another, is only loaded
+/// once, and its paths are recorded in its "source_paths" member.
+/// \param the directories to search
 /// \returns a vector of the found implementations
 ///
 std::vector<nlohmann::json> find_sycl_impls(
@@ -82,11 +244,48 @@ void dump_impls(const std::vector<nlohmann::json>& implementations,
 ///
 void print_impls(std::ostream& out, std::string hint = {});
 
+/// \brief Retrieves the directories searched for .syclinfo files
+/// \param an optional hint, searched after the directories of
+/// SYCL_VENDOR_PATHS
+/// \returns the directories, in the order they are searched
+///
+std::vector<std::string> get_vendor_paths(std::string hint = {});
+
 /// \brief Utility function that retrieves the found SYCL implementation
 /// \returns a vector of info for each implementation found
 ///
 std::vector<nlohmann::json> get_impls(std::string hint = {});
 
+/// \brief The result of find_impl()
+///
+struct impl_lookup {
+  bool found;
+  /// \brief The index of the implementation as listed by sycl-info, from 1
+  unsigned int index;
+  nlohmann::json impl;
+};
+
+/// \brief Finds the implementation requested with --impl without loading
+/// every implementation. A request made only of digits is an index: the
+/// files before it are counted without being parsed. Otherwise it is a name,
+/// and the files are parsed until one has that name, starting with the files
+/// whose file name contains it (e.g. computecpp.syclinfo for ComputeCpp).
+/// When several have that name, the first one listed is found, as with
+/// find_impl_index().
+/// \param the name or index (from 1) of the implementation and an optional
+/// hint, as for get_impls()
+/// \returns the implementation and its index, if found
+///
+impl_lookup find_impl(const std::string& requested, std::string hint = {});
+
+/// \brief Resolves the implementation requested with --impl in a list
+/// returned by get_impls(), as find_impl() does: a request made only of
+/// digits is an index, anything else a name
+/// \returns the index of the implementation, from 1, or 0 if there is none
+///
+unsigned int find_impl_index(const std::string& requested,
+                             const std::vector<nlohmann::json>& impls);
+
 /// \brief Helper function thas accesses the SYCL_VENDOR_PATH env variable
 /// \returns a string with the path set in the SYCL_VENDOR_PATH env variable
 ///
@@ -33,11 +33,13 @@ using_target_matcher::print_type using_target_matcher::from_json(
   using plat_vendor = select<selections::plat_vendor>;
   using dev_name = select<selections::dev_name>;
   using dev_vendor = select<selections::dev_vendor>;
+  using dev_type = select<selections::dev_type>;
   using drivers = select<selections::supported_drivers>;
 
   for (const auto& config : syclImp[supported_config::value]) {
     platform plat = {config[plat_name::value], config[plat_vendor::value], {}};
-    device dev = {config[dev_name::value], config[dev_vendor::value], {}};
+    device dev = {config[dev_name::value], config[dev_vendor::value], {},
+                  config.value(dev_type::value, std::string{}), {}};
     std::copy(config[drivers::value].begin(), config[drivers::value].end(),
               std::back_inserter(dev.drivers));
 
@@ -78,6 +80,7 @@ using_target_matcher::print_type using_target_matcher::from_json(
 
 using_target_matcher::print_type using_target_matcher::match(
     const nlohmann::json& syclImpJson, const print_type& systemImp) {
+  target_selector::scoped_timer timer{"match"};
   print_type syclImp = from_json(syclImpJson);
   print_type result;
 
@@ -118,32 +121,190 @@ void dump_picked_impl(const using_target_matcher::print_type& platforms,
   }
 }
 
+/// @brief Converts a platform id to its print representation. The devices
+/// of the returned platform are left empty.
+///
+static using_target_matcher::platform make_platform(cl_platform_id id) {
+  using target_selector::get_info_from_opencl;
+  using target_selector::trim_end;
+
+  using_target_matcher::platform plat;
+  plat.name = target_selector::get_platform_name(id);
+  plat.vendor =
+      trim_end(get_info_from_opencl(id, CL_PLATFORM_VENDOR, clGetPlatformInfo));
+  return plat;
+}
+
+/// @brief Converts an OpenCL device type to the name used by the device_type
+/// field of the syclinfo files
+///
+static std::string device_type_name(cl_device_type type) {
+  if (type & CL_DEVICE_TYPE_GPU) {
+    return "GPU";
+  }
+  if (type & CL_DEVICE_TYPE_CPU) {
+    return "CPU";
+  }
+  if (type & CL_DEVICE_TYPE_ACCELERATOR) {
+    return "ACCEL";
+  }
+  return std::string{};
+}
+
+/// @brief Converts a device id to its print representation
+///
+static using_target_matcher::device make_device(cl_device_id id) {
+  using target_selector::get_info_from_opencl;
+  using target_selector::trim_end;
+
+  using_target_matcher::device dev;
+  dev.name =
+      trim_end(get_info_from_opencl(id, CL_DEVICE_NAME, clGetDeviceInfo));
+  dev.vendor =
+      trim_end(get_info_from_opencl(id, CL_DEVICE_VENDOR, clGetDeviceInfo));
+  dev.driverVersion =
+      trim_end(get_info_from_opencl(id, CL_DRIVER_VERSION, clGetDeviceInfo));
+
+  auto type = cl_device_type{0};
+  target_selector::target_selector_warn_on_cl_error(
+      [id, &type]() {
+        return clGetDeviceInfo(id, CL_DEVICE_TYPE, sizeof(type), &type,
+                               nullptr);
+      },
+      "Failed to retrieve the device type");
+  dev.type = device_type_name(type);
+  return dev;
+}
+
+/// @brief Adds a platform (without its devices) to a print_type
+/// @return An iterator to the platform stored in the print_type
+///
+static using_target_matcher::print_type::iterator insert_platform(
+    using_target_matcher::print_type& result,
+    const using_target_matcher::platform& plat) {
+  return result
+      .insert(using_target_matcher::platform{plat.name, plat.vendor, {}})
+      .first;
+}
+
 using_target_matcher::print_type to_print_type(
     const std::vector<std::pair<cl_platform_id, cl_device_id>>& devices) {
   using_target_matcher::print_type converted;
 
   for (const auto device : devices) {
-    using namespace target_selector;
-    using_target_matcher::platform plat;
-
-    using_target_matcher::device dev;
-    plat.name = trim_end(target_selector::get_info_from_opencl(
-        device.first, CL_PLATFORM_NAME, clGetPlatformInfo));
-    plat.vendor = trim_end(target_selector::get_info_from_opencl(
-        device.first, CL_PLATFORM_VENDOR, clGetPlatformInfo));
-
-    dev.name = trim_end(target_selector::get_info_from_opencl(
-        device.second, CL_DEVICE_NAME, clGetDeviceInfo));
-    dev.vendor = trim_end(target_selector::get_info_from_opencl(
-        device.second, CL_DEVICE_VENDOR, clGetDeviceInfo));
-
-    auto it = converted.insert(std::move(plat));
-    it.first->devices.insert(std::move(dev));
+    auto it = insert_platform(converted, make_platform(device.first));
+    it->devices.insert(make_device(device.second));
   }
 
   return converted;
 }
 
+/// @brief Wraps a device_visitor so that it can be passed to the
+/// target_selector, converting the OpenCL ids to their print representation
+///
+static target_selector::device_visitor make_converting_visitor(
+    const device_visitor& visitor) {
+  // Devices are reported grouped by platform, so the platform information only
+  // needs to be queried once per platform
+  auto lastPlatform = cl_platform_id{nullptr};
+  auto plat = using_target_matcher::platform{};
+  return [=](cl_platform_id platformId, cl_device_id deviceId) mutable {
+    if (platformId != lastPlatform) {
+      plat = make_platform(platformId);
+      lastPlatform = platformId;
+    }
+    return visitor(plat, make_device(deviceId));
+  };
+}
+
+bool enumerate_devices(const device_visitor& visitor) {
+  auto platforms = std::unordered_map<std::string, std::string>{};
+
+  bool all = true;
+  return target_selector::visit_devices(make_converting_visitor(visitor), "*",
+                                        "*", all, platforms, all);
+}
+
+device_type_map supported_device_types(const nlohmann::json& syclImp) {
+  using supported_config = select<selections::supported_configurations>;
+  using plat_name = select<selections::plat_name>;
+  using dev_type = select<selections::dev_type>;
+
+  auto deviceTypes = device_type_map{};
+  for (const auto& config : syclImp[supported_config::value]) {
+    const auto type = target_selector::match_device_type(
+        config.value(dev_type::value, std::string{"*"}));
+    auto& mask = deviceTypes[config[plat_name::value].get<std::string>()];
+    mask |= (type != 0) ? type : cl_device_type{CL_DEVICE_TYPE_ALL};
+  }
+  return deviceTypes;
+}
+
+/// @brief Enumerates only the given platforms, and only the given device types
+/// of each of them
+///
+static bool enumerate_supported_devices(const device_visitor& visitor,
+                                        const device_type_map& deviceTypes) {
+  constexpr bool all = true;
+  return target_selector::visit_devices(
+      make_converting_visitor(visitor),
+      [&deviceTypes](const std::string& platformName) {
+        const auto it = deviceTypes.find(platformName);
+        return (it != deviceTypes.end()) ? it->second : cl_device_type{0};
+      },
+      all);
+}
+
+/// @brief Enumerates the given platforms and device types from previously
+/// recorded hardware, the same way they would be enumerated from OpenCL
+///
+static bool enumerate_supported_devices(
+    const device_visitor& visitor,
+    const using_target_matcher::print_type& hardware,
+    const device_type_map& deviceTypes) {
+  for (const auto& plat : hardware) {
+    const auto it = deviceTypes.find(plat.name);
+    if (it == deviceTypes.end()) {
+      continue;
+    }
+
+    for (const auto& dev : plat.devices) {
+      // Devices recorded without a type were visible to any device type query
+      const auto type = dev.type.empty()
+                            ? cl_device_type{CL_DEVICE_TYPE_ALL}
+                            : target_selector::match_device_type(dev.type);
+      if ((type & it->second) && !visitor(plat, dev)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool enumerate_devices(const device_visitor& visitor,
+                       const nlohmann::json& syclImp) {
+  return enumerate_supported_devices(visitor, supported_device_types(syclImp));
+}
+
+bool enumerate_devices(const device_visitor& visitor,
+                       const using_target_matcher::print_type& hardware) {
+  for (const auto& plat : hardware) {
+    for (const auto& dev : plat.devices) {
+      if (!visitor(plat, dev)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool enumerate_devices(const device_visitor& visitor,
+                       const using_target_matcher::print_type& hardware,
+                       const nlohmann::json& syclImp) {
+  return enumerate_supported_devices(visitor, hardware,
+                                     supported_device_types(syclImp));
+}
+
 std::pair<bool, int> retrieve_index_for_impl(
     const std::string& chosenImpl,
     const std::vector<nlohmann::json>& impls) noexcept {
@@ -169,27 +330,88 @@ std::pair<bool, int> retrieve_index_for_impl(
   }
 }
 
+// Matching is pipelined with the enumeration: each platform/device pair is
+// looked up in the implementation's configurations as soon as it is
+// enumerated, which yields the same result as using_target_matcher::match()
+// without first converting every device on the system. Only the platforms
+// and device types listed by the implementation are enumerated, and once
+// every configuration it lists has been found nothing else can match, so the
+// remaining platforms are not enumerated at all.
+static using_target_matcher::print_type match_supported_devices(
+    const using_target_matcher::print_type& supported,
+    const device_type_map& deviceTypes,
+    const using_target_matcher::print_type* hardware) {
+  using_target_matcher::print_type result;
+  auto remaining = std::size_t{0};
+  for (const auto& plat : supported) {
+    remaining += plat.devices.size();
+  }
+  if (remaining == 0) {
+    return result;
+  }
+
+  const auto match_device = [&](const using_target_matcher::platform& plat,
+                                const using_target_matcher::device& dev) {
+    const auto supportedPlat = supported.find(plat);
+    if (supportedPlat == supported.end()) {
+      return true;
+    }
+
+    // Keep the implementation's records, as match() does, so that the
+    // supported drivers are reported
+    auto matchedPlat = insert_platform(result, *supportedPlat);
+    const auto supportedDev = supportedPlat->devices.find(dev);
+    if (supportedDev != supportedPlat->devices.end() &&
+        matchedPlat->devices.insert(*supportedDev).second) {
+      --remaining;
+    }
+    return remaining != 0;
+  };
+  if (hardware) {
+    enumerate_supported_devices(match_device, *hardware, deviceTypes);
+  } else {
+    enumerate_supported_devices(match_device, deviceTypes);
+  }
+
+  return result;
+}
+
+using_target_matcher::print_type match_supported(
+    const using_target_matcher::print_type& supported,
+    const device_type_map& deviceTypes,
+    const using_target_matcher::print_type* hardware) {
+  target_selector::scoped_timer timer{"match"};
+  return match_supported_devices(supported, deviceTypes, hardware);
+}
+
 using_target_matcher::print_type match_picked_impl(
     const unsigned int index, const std::vector<nlohmann::json>& impls,
-    const bool displayAll) {
-  auto devices = std::vector<std::pair<cl_platform_id, cl_device_id>>();
-  auto platforms = std::unordered_map<std::string, std::string>{};
-
-  bool all = true;
-  target_selector::find_devices(devices, "*", "*", all, platforms, all);
+    const bool displayAll, const using_target_matcher::print_type* hardware) {
+  target_selector::scoped_timer timer{"match"};
+  using_target_matcher::print_type result;
 
-  using_target_matcher::print_type devs = to_print_type(devices);
   if (displayAll) {
-    return devs;
-  } else {
-    return using_target_matcher::match(impls[index - 1], devs);
+    if (hardware) {
+      return *hardware;
+    }
+    enumerate_devices([&result](const using_target_matcher::platform& plat,
+                                const using_target_matcher::device& dev) {
+      insert_platform(result, plat)->devices.insert(dev);
+      return true;
+    });
+    return result;
   }
+
+  const auto& impl = impls[index - 1];
+  return match_supported_devices(using_target_matcher::from_json(impl),
+                                 supported_device_types(impl), hardware);
 }
 
 void print_picked_impl(const unsigned int index,
                        const std::vector<nlohmann::json>& impls,
-                       const bool displayAll, std::ostream& out) {
-  const auto result = match_picked_impl(index, impls, displayAll);
+                       const bool displayAll, std::ostream& out,
+                       const using_target_matcher::print_type* hardware) {
+  const auto result = match_picked_impl(index, impls, displayAll, hardware);
   dump_picked_impl(result, out);
 }
 
@@ -212,9 +434,10 @@ bool is_config_index_valid(const using_target_matcher::print_type& impls,
 config get_config(const unsigned int index,
                   const std::vector<nlohmann::json>& impls,
                   const std::pair<int, int> configIndex,
-                  const bool displayAll) {
+                  const bool displayAll,
+                  const using_target_matcher::print_type* hardware) {
   // sycl_info outputs starts from 1...N
-  const auto result = match_picked_impl(index, impls, displayAll);
+  const auto result = match_picked_impl(index, impls, displayAll, hardware);
   if (is_config_index_valid(result, configIndex)) {
     auto platIt = result.begin();
     std::advance(platIt, configIndex.first - 1);
@@ -266,6 +489,7 @@ backend_info get_default_backend(
 backend_info match_config_with_impls(const config& conf,
                                      const nlohmann::json& impl,
                                      const std::string& target) {
+  target_selector::scoped_timer timer{"match"};
   using configs = select<selections::supported_configurations>;
   using platform = select<selections::plat_name>;
   using device = select<selections::dev_name>;
@@ -291,6 +515,30 @@ backend_info match_config_with_impls(const config& conf,
   return backend_info{};
 }
 
+std::vector<backend_info> match_config_backends(const config& conf,
+                                                const nlohmann::json& impl) {
+  using configs = select<selections::supported_configurations>;
+  using platform = select<selections::plat_name>;
+  using device = select<selections::dev_name>;
+  using supported_backend = select<selections::supported_backend_targets>;
+  using backend = select<selections::backend>;
+  using dev_flags = select<selections::dev_flags>;
+
+  // The first listed configuration wins, as in match_config_with_impls()
+  auto backends = std::vector<backend_info>{};
+  for (const auto& elem : impl[configs::value]) {
+    if ((elem[platform::value] == conf.platform) &&
+        (elem[device::value] == conf.device)) {
+      for (const auto& target : elem[supported_backend::value]) {
+        backends.push_back(
+            backend_info{target[backend::value], target[dev_flags::value]});
+      }
+      break;
+    }
+  }
+  return backends;
+}
+
 void dump_config(const backend_info& info, std::ostream& out) noexcept {
   out << "Backend: " << info.backend << "\n"
       << "Device flags: " << info.deviceFlags << "\n";
@@ -300,8 +548,10 @@ void print_config(const unsigned int index,
                   const std::vector<nlohmann::json>& impls,
                   const std::pair<int, int> configIndex,
                   const std::string& target, const bool displayAll,
-                  std::ostream& out) {
-  const auto config = get_config(index, impls, configIndex, displayAll);
+                  std::ostream& out,
+                  const using_target_matcher::print_type* hardware) {
+  const auto config =
+      get_config(index, impls, configIndex, displayAll, hardware);
   if (!config.platform.empty()) {
     // sycl_info outputs starts from 1...N
     const auto info = match_config_with_impls(config, impls[index - 1], target);
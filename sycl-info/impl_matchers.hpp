@@ -21,11 +21,13 @@
 #define IMPL_MATCHERS_H
 
 #include <CL/opencl.h>
+#include <functional>
 #include <iostream>
 #include <nlohmann/json.hpp>
 #include <set>
 #include <string>
 #include <tuple>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -83,6 +85,12 @@ struct using_target_matcher {
     /// comparison function used by the data structure
     ///
     mutable std::vector<std::string> drivers;
+    /// @brief Device properties (e.g. "GPU" and the OpenCL driver version).
+    /// These are not part of the comparison either; the type of a
+    /// syclinfo device comes from its configuration.
+    ///
+    std::string type;
+    std::string driverVersion;
 
     /// @brief The container of this is an std::set which requires
     /// strict weak ordering
@@ -151,6 +159,48 @@ struct using_target_matcher {
 using_target_matcher::print_type to_print_type(
     const std::vector<std::pair<cl_platform_id, cl_device_id>>& devices);
 
+/// @brief Callback invoked for every platform/device pair as soon as it has
+/// been enumerated. Returning false cancels the enumeration.
+///
+using device_visitor =
+    std::function<bool(const using_target_matcher::platform&,
+                       const using_target_matcher::device&)>;
+
+/// @brief Enumerates the system's platforms/devices and hands each pair to
+/// the visitor in its print representation, without waiting for the rest of
+/// the platforms to be enumerated
+/// @param The visitor to call for each platform/device pair
+/// @return false if the visitor cancelled the enumeration, true otherwise
+///
+bool enumerate_devices(const device_visitor& visitor);
+
+/// @brief Enumerates only the platforms listed by a syclinfo file, and only
+/// the device types it lists for each of them. Platforms that are not listed
+/// are skipped before any of their devices are queried.
+/// @param The visitor to call for each platform/device pair and the syclinfo
+/// json whose configurations select what is enumerated
+/// @return false if the visitor cancelled the enumeration, true otherwise
+///
+bool enumerate_devices(const device_visitor& visitor,
+                       const nlohmann::json& syclImp);
+
+/// @brief Enumerates previously recorded hardware (e.g. a hardware snapshot)
+/// instead of querying OpenCL
+/// @param The visitor to call for each platform/device pair and the hardware
+/// to enumerate
+/// @return false if the visitor cancelled the enumeration, true otherwise
+///
+bool enumerate_devices(const device_visitor& visitor,
+                       const using_target_matcher::print_type& hardware);
+
+/// @brief Enumerates the platforms and device types listed by a syclinfo
+/// file from previously recorded hardware, the same way they would be
+/// enumerated from OpenCL
+///
+bool enumerate_devices(const device_visitor& visitor,
+                       const using_target_matcher::print_type& hardware,
+                       const nlohmann::json& syclImp);
+
 /// @brief Pretty print function for the --using command line option
 /// @param A result of type print_type retrieved by the match()
 /// function and an ostream to print to
@@ -169,19 +219,47 @@ std::pair<bool, int> retrieve_index_for_impl(
 
 /// @brief Matches the --impl index with the available implementations
 /// @param The --impl index, a vector of the syclinfo implementations
-/// to match
+/// to match and optionally the hardware to match against (e.g. from a
+/// hardware snapshot). The system's devices are enumerated when no hardware
+/// is given.
 ///
 using_target_matcher::print_type match_picked_impl(
     const unsigned int index, const std::vector<nlohmann::json>& impls,
-    const bool displayAll);
+    const bool displayAll,
+    const using_target_matcher::print_type* hardware = nullptr);
+
+/// @brief The OpenCL device types an implementation lists for each of its
+/// platforms, which select what is enumerated when matching it
+///
+using device_type_map = std::unordered_map<std::string, cl_device_type>;
+
+/// @brief Collects the device types listed by each platform of a syclinfo
+/// file. A configuration without a (known) device type selects every device
+/// type of its platform.
+///
+device_type_map supported_device_types(const nlohmann::json& syclImp);
+
+/// @brief Matches the platforms/devices supported by an implementation with
+/// the hardware, as match_picked_impl() does without --all
+/// @param The supported platforms/devices (e.g. from from_json()), the
+/// device types of each supported platform and optionally the hardware to
+/// match against. The system's devices are enumerated when no hardware is
+/// given.
+///
+using_target_matcher::print_type match_supported(
+    const using_target_matcher::print_type& supported,
+    const device_type_map& deviceTypes,
+    const using_target_matcher::print_type* hardware = nullptr);
 
 /// @brief Picks a sycl-info implementation and displays it
 /// @param The --using-target index, a vector of the syclinfo
-/// implementations and an ostream to print to
+/// implementations, an ostream to print to and optionally the hardware to
+/// match against
 ///
-void print_picked_impl(const unsigned int index,
-                       const std::vector<nlohmann::json>& impls,
-                       const bool displayAll, std::ostream& out);
+void print_picked_impl(
+    const unsigned int index, const std::vector<nlohmann::json>& impls,
+    const bool displayAll, std::ostream& out,
+    const using_target_matcher::print_type* hardware = nullptr);
 
 /// @brief Structure for platform/device pair to represent the --config option
 ///
@@ -195,7 +273,8 @@ struct config {
 ///
 config get_config(const unsigned int index,
                   const std::vector<nlohmann::json>& impls,
-                  const std::pair<int, int> configIndex, const bool displayAll);
+                  const std::pair<int, int> configIndex, const bool displayAll,
+                  const using_target_matcher::print_type* hardware = nullptr);
 
 /// @brief prints the config
 ///
@@ -203,7 +282,8 @@ void print_config(const unsigned int index,
                   const std::vector<nlohmann::json>& impls,
                   const std::pair<int, int> configIndex,
                   const std::string& target, const bool displayAll,
-                  std::ostream& out);
+                  std::ostream& out,
+                  const using_target_matcher::print_type* hardware = nullptr);
 
 /// @brief Checks if the user specified option config_ is a valid index
 /// @return True if config_ is a valid index, false otherwise
@@ -238,6 +318,13 @@ backend_info match_config_with_impls(const config& conf,
                                      const nlohmann::json& impl,
                                      const std::string& target);
 
+/// @brief Helper function that matches an implementation file with a
+/// configuration and returns every backend it supports, the default one first
+/// @return The backends of the configuration, empty if it is not listed
+///
+std::vector<backend_info> match_config_backends(const config& conf,
+                                                const nlohmann::json& impl);
+
 /// @brief Dumps the backend information specified by --config to a stream
 //
 void dump_config(const backend_info& info, std::ostream& out) noexcept;
@@ -248,6 +335,7 @@ enum class selections {
   supported_configurations,
   plat_name,
   plat_vendor,
+  dev_type,
   dev_name,
   dev_flags,
   dev_vendor,
@@ -285,6 +373,13 @@ struct select<selections::plat_vendor> {
   static constexpr const char* value = "platform_vendor";
 };
 
+/// @brief Specialization for selections::dev_type
+///
+template <>
+struct select<selections::dev_type> {
+  static constexpr const char* value = "device_type";
+};
+
 /// @brief Specialization for selections::device_name
 ///
 template <>
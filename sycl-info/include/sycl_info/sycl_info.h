@@ -0,0 +1,150 @@
+////////////////////////////////////////////////////////////////////////////////
+// sycl_info.h
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SYCL_INFO_SYCL_INFO_H
+#define SYCL_INFO_SYCL_INFO_H
+
+#include "sycl_info/export.h"
+
+#include <stddef.h>
+
+/*
+ * The C interface of sycl-info: the same queries as the sycl-info tool,
+ * in-process.
+ *
+ * - Handles are opaque and owned by the caller, who releases each of them
+ *   with its destroy function. Strings returned by the library belong to the
+ *   handle they were read from and stay valid until it is destroyed.
+ * - Functions that can fail return a sycl_info_status; the reason for the
+ *   last failure on the calling thread is returned by sycl_info_last_error().
+ * - Indices start at 0, unlike the indices displayed by the tool.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum sycl_info_status {
+  SYCL_INFO_SUCCESS = 0,
+  /* A handle was NULL or an index was out of range */
+  SYCL_INFO_INVALID_ARGUMENT = 1,
+  /* The configuration or backend that was asked for is not listed */
+  SYCL_INFO_NOT_FOUND = 2,
+  /* Any other failure, e.g. a file that could not be read or parsed */
+  SYCL_INFO_ERROR = 3
+} sycl_info_status;
+
+/* The SYCL implementations described by the .syclinfo files */
+typedef struct sycl_info_catalog_t* sycl_info_catalog;
+/* A set of platforms/devices, captured from OpenCL or read from a file */
+typedef struct sycl_info_snapshot_t* sycl_info_snapshot;
+/* The platform/device configurations of an implementation that a snapshot,
+ * or the system, supports */
+typedef struct sycl_info_matches_t* sycl_info_matches;
+
+/* The version of the library, e.g. "0.1" */
+SYCL_INFO_EXPORT const char* sycl_info_version(void);
+
+/* Describes the last failure on the calling thread */
+SYCL_INFO_EXPORT const char* sycl_info_last_error(void);
+
+/* ---- Catalog ------------------------------------------------------------ */
+
+/* Loads the .syclinfo files found in SYCL_VENDOR_PATHS and, unless it is
+ * NULL, in the hint directory */
+SYCL_INFO_EXPORT sycl_info_status
+sycl_info_catalog_create(const char* hint, sycl_info_catalog* catalog);
+
+SYCL_INFO_EXPORT void sycl_info_catalog_destroy(sycl_info_catalog catalog);
+
+/* The number of implementations in the catalog */
+SYCL_INFO_EXPORT size_t sycl_info_catalog_size(sycl_info_catalog catalog);
+
+/* The name, vendor and version of an implementation, or NULL if the index
+ * is out of range */
+SYCL_INFO_EXPORT const char* sycl_info_impl_name(sycl_info_catalog catalog,
+                                                 size_t impl);
+SYCL_INFO_EXPORT const char* sycl_info_impl_vendor(sycl_info_catalog catalog,
+                                                   size_t impl);
+SYCL_INFO_EXPORT const char* sycl_info_impl_version(sycl_info_catalog catalog,
+                                                    size_t impl);
+
+/* Looks up the device flags of a configuration listed by an implementation.
+ * A NULL backend selects the default (first) backend of the configuration. */
+SYCL_INFO_EXPORT sycl_info_status sycl_info_device_flags(
+    sycl_info_catalog catalog, size_t impl, const char* platform,
+    const char* device, const char* backend, const char** flags);
+
+/* ---- Snapshot ----------------------------------------------------------- */
+
+/* Queries the platforms/devices of the system through OpenCL */
+SYCL_INFO_EXPORT sycl_info_status
+sycl_info_snapshot_capture(sycl_info_snapshot* snapshot);
+
+/* Reads a hardware snapshot written by sycl-info --snapshot-out or by
+ * sycl_info_snapshot_save() */
+SYCL_INFO_EXPORT sycl_info_status
+sycl_info_snapshot_load(const char* path, sycl_info_snapshot* snapshot);
+
+SYCL_INFO_EXPORT sycl_info_status
+sycl_info_snapshot_save(sycl_info_snapshot snapshot, const char* path);
+
+SYCL_INFO_EXPORT void sycl_info_snapshot_destroy(sycl_info_snapshot snapshot);
+
+/* ---- Matches ------------------------------------------------------------ */
+
+/* Matches an implementation with a snapshot, or with the system's devices
+ * when the snapshot is NULL. The configurations are in the order the tool
+ * displays them for --impl. */
+SYCL_INFO_EXPORT sycl_info_status sycl_info_match(sycl_info_catalog catalog,
+                                                  size_t impl,
+                                                  sycl_info_snapshot snapshot,
+                                                  sycl_info_matches* matches);
+
+SYCL_INFO_EXPORT void sycl_info_matches_destroy(sycl_info_matches matches);
+
+/* The number of matched platform/device configurations */
+SYCL_INFO_EXPORT size_t sycl_info_matches_size(sycl_info_matches matches);
+
+/* The platform name, device name and device type (e.g. "GPU") of a matched
+ * configuration, or NULL if the index is out of range */
+SYCL_INFO_EXPORT const char* sycl_info_match_platform(
+    sycl_info_matches matches, size_t config);
+SYCL_INFO_EXPORT const char* sycl_info_match_device(sycl_info_matches matches,
+                                                    size_t config);
+SYCL_INFO_EXPORT const char* sycl_info_match_device_type(
+    sycl_info_matches matches, size_t config);
+
+/* The number of backends of a matched configuration, the default first */
+SYCL_INFO_EXPORT size_t sycl_info_match_backend_count(
+    sycl_info_matches matches, size_t config);
+
+/* The name and device flags of a backend of a matched configuration, or
+ * NULL if an index is out of range */
+SYCL_INFO_EXPORT const char* sycl_info_match_backend(sycl_info_matches matches,
+                                                     size_t config,
+                                                     size_t backend);
+SYCL_INFO_EXPORT const char* sycl_info_match_device_flags(
+    sycl_info_matches matches, size_t config, size_t backend);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SYCL_INFO_SYCL_INFO_H
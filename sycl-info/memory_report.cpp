@@ -0,0 +1,250 @@
+////////////////////////////////////////////////////////////////////////////////
+// memory_report.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "memory_report.hpp"
+
+#include <atomic>
+#include <iomanip>
+#include <mutex>
+#include <unordered_set>
+#include <utility>
+
+#ifdef _WIN32
+// GetProcessMemoryInfo from kernel32, so that psapi.lib is not needed
+#define PSAPI_VERSION 2
+#include <windows.h>
+// windows.h has to come first
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace sycl_info {
+
+std::size_t peak_resident_set_size() noexcept {
+#ifdef _WIN32
+  auto counters = PROCESS_MEMORY_COUNTERS{};
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters,
+                            sizeof(counters))) {
+    return 0;
+  }
+  return counters.PeakWorkingSetSize;
+#else
+  auto usage = rusage{};
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#ifdef __APPLE__
+  // Bytes on macOS, kilobytes everywhere else
+  return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+  return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+/// @brief The bytes a std::set or std::map node adds to its element: the
+/// colour and the parent, left and right pointers
+///
+constexpr std::size_t treeNodeHeader = 4 * sizeof(void*);
+
+/// @brief The heap block of a string, none while it fits the small string
+/// buffer
+///
+static std::size_t string_heap(const std::string& value) noexcept {
+  static const auto smallCapacity = std::string{}.capacity();
+  return (value.capacity() > smallCapacity) ? value.capacity() + 1 : 0;
+}
+
+template <class T>
+static std::size_t vector_heap(const std::vector<T>& values) noexcept {
+  return values.capacity() * sizeof(T);
+}
+
+std::size_t footprint(const std::string& value) noexcept {
+  return sizeof(value) + string_heap(value);
+}
+
+/// @brief The heap blocks owned by a json value, without the value itself
+///
+static std::size_t json_heap(const nlohmann::json& value) {
+  auto bytes = std::size_t{0};
+  if (value.is_string()) {
+    const auto& string = value.get_ref<const nlohmann::json::string_t&>();
+    bytes += footprint(string);
+  } else if (value.is_array()) {
+    const auto& array = value.get_ref<const nlohmann::json::array_t&>();
+    bytes += sizeof(array) + vector_heap(array);
+    for (const auto& element : array) {
+      bytes += json_heap(element);
+    }
+  } else if (value.is_object()) {
+    const auto& object = value.get_ref<const nlohmann::json::object_t&>();
+    bytes += sizeof(object);
+    for (const auto& member : object) {
+      bytes += treeNodeHeader + sizeof(member) + string_heap(member.first) +
+               json_heap(member.second);
+    }
+  }
+  return bytes;
+}
+
+std::size_t footprint(const nlohmann::json& value) {
+  return sizeof(value) + json_heap(value);
+}
+
+std::size_t footprint(const std::vector<nlohmann::json>& impls) {
+  auto bytes = sizeof(impls) + vector_heap(impls);
+  for (const auto& impl : impls) {
+    bytes += json_heap(impl);
+  }
+  return bytes;
+}
+
+static std::size_t strings_heap(const std::vector<std::string>& values) {
+  auto bytes = vector_heap(values);
+  for (const auto& value : values) {
+    bytes += string_heap(value);
+  }
+  return bytes;
+}
+
+static std::size_t backend_heap(const backend_info& info) noexcept {
+  return string_heap(info.backend) + string_heap(info.deviceFlags);
+}
+
+std::size_t footprint(const backend_info& info) noexcept {
+  return sizeof(info) + backend_heap(info);
+}
+
+/// @brief The heap blocks owned by an implementation record, without the
+/// record itself. Backend lists shared with records already counted are not
+/// counted again.
+///
+static std::size_t compact_heap(
+    const compact_impl& impl,
+    std::unordered_set<const std::vector<backend_info>*>& counted) {
+  // The control block of std::make_shared: two reference counts and a vtable
+  constexpr auto sharedHeader = 2 * sizeof(long) + sizeof(void*);
+
+  auto bytes = string_heap(impl.name) + string_heap(impl.vendor) +
+               string_heap(impl.version) + vector_heap(impl.configs);
+  for (const auto& conf : impl.configs) {
+    bytes += string_heap(conf.platformName) +
+             string_heap(conf.platformVendor) + string_heap(conf.deviceType) +
+             string_heap(conf.deviceName) + string_heap(conf.deviceVendor) +
+             strings_heap(conf.drivers);
+    if (!counted.insert(conf.backends.get()).second) {
+      continue;
+    }
+    bytes += sharedHeader + sizeof(*conf.backends) +
+             vector_heap(*conf.backends);
+    for (const auto& info : *conf.backends) {
+      bytes += backend_heap(info);
+    }
+  }
+  return bytes;
+}
+
+std::size_t footprint(const compact_impl& impl) {
+  auto counted = std::unordered_set<const std::vector<backend_info>*>{};
+  return sizeof(impl) + compact_heap(impl, counted);
+}
+
+std::size_t footprint(const std::vector<compact_impl>& impls) {
+  auto counted = std::unordered_set<const std::vector<backend_info>*>{};
+  auto bytes = sizeof(impls) + vector_heap(impls);
+  for (const auto& impl : impls) {
+    bytes += compact_heap(impl, counted);
+  }
+  return bytes;
+}
+
+std::size_t footprint(const using_target_matcher::print_type& hardware) {
+  auto bytes = sizeof(hardware);
+  for (const auto& plat : hardware) {
+    bytes += treeNodeHeader + sizeof(plat) + string_heap(plat.name) +
+             string_heap(plat.vendor);
+    for (const auto& dev : plat.devices) {
+      bytes += treeNodeHeader + sizeof(dev) + string_heap(dev.name) +
+               string_heap(dev.vendor) + strings_heap(dev.drivers) +
+               string_heap(dev.type) + string_heap(dev.driverVersion);
+    }
+  }
+  return bytes;
+}
+
+namespace {
+struct structure_footprint {
+  std::string structure;
+  std::size_t items;
+  std::size_t bytes;
+};
+
+std::atomic<bool> reportEnabled{false};
+std::mutex footprintsMutex;
+std::vector<structure_footprint> footprints;
+}  // namespace
+
+void enable_memory_report(bool enabled) noexcept {
+  reportEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool memory_report_enabled() noexcept {
+  return reportEnabled.load(std::memory_order_relaxed);
+}
+
+void record_footprint(const std::string& structure, std::size_t items,
+                      std::size_t bytes) {
+  std::lock_guard<std::mutex> lock{footprintsMutex};
+  for (auto& recorded : footprints) {
+    if (recorded.structure == structure) {
+      recorded.items += items;
+      recorded.bytes += bytes;
+      return;
+    }
+  }
+  footprints.push_back(structure_footprint{structure, items, bytes});
+}
+
+void write_memory_report(std::ostream& out) {
+  out << std::left << std::setw(28) << "Structure" << std::right
+      << std::setw(8) << "Items" << std::setw(14) << "Bytes" << '\n';
+  {
+    std::lock_guard<std::mutex> lock{footprintsMutex};
+    for (const auto& recorded : footprints) {
+      out << std::left << std::setw(28) << recorded.structure << std::right
+          << std::setw(8) << recorded.items << std::setw(14) << recorded.bytes
+          << '\n';
+    }
+  }
+
+  const auto peak = peak_resident_set_size();
+  out << "Peak RSS: ";
+  if (peak == 0) {
+    out << "unavailable\n";
+  } else {
+    out << std::fixed << std::setprecision(1)
+        << static_cast<double>(peak) / (1024.0 * 1024.0) << " MiB (" << peak
+        << " bytes)\n"
+        << std::defaultfloat;
+  }
+}
+
+}  // namespace sycl_info
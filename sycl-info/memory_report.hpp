@@ -0,0 +1,73 @@
+////////////////////////////////////////////////////////////////////////////////
+// memory_report.hpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SYCL_INFO_MEMORY_REPORT_HPP
+#define SYCL_INFO_MEMORY_REPORT_HPP
+
+#include "compact_catalog.hpp"
+#include "impl_matchers.hpp"
+#include <cstddef>
+#include <nlohmann/json.hpp>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace sycl_info {
+
+/// @brief The peak resident set size of the process in bytes, or 0 where it
+/// cannot be queried
+///
+std::size_t peak_resident_set_size() noexcept;
+
+/// @brief Estimates the bytes held by a structure: its own size plus every
+/// heap block it owns, without the allocator's bookkeeping. Node-based
+/// containers are counted with a typical node header, and backend lists
+/// shared by several records are counted once.
+///
+std::size_t footprint(const std::string& value) noexcept;
+std::size_t footprint(const nlohmann::json& value);
+std::size_t footprint(const std::vector<nlohmann::json>& impls);
+std::size_t footprint(const compact_impl& impl);
+std::size_t footprint(const std::vector<compact_impl>& impls);
+std::size_t footprint(const using_target_matcher::print_type& hardware);
+std::size_t footprint(const backend_info& info) noexcept;
+
+/// @brief Turns the recording of footprints for --memory-report on or off.
+/// Off by default, so that the structures are not walked otherwise.
+///
+void enable_memory_report(bool enabled) noexcept;
+
+/// @brief Returns whether footprints are being recorded
+///
+bool memory_report_enabled() noexcept;
+
+/// @brief Adds the items and bytes of a structure to the memory report.
+/// Structures recorded several times (e.g. per device set) are summed up.
+///
+void record_footprint(const std::string& structure, std::size_t items,
+                      std::size_t bytes);
+
+/// @brief Writes the recorded structures and the peak resident set size,
+/// for --memory-report
+///
+void write_memory_report(std::ostream& out);
+
+}  // namespace sycl_info
+
+#endif  // SYCL_INFO_MEMORY_REPORT_HPP
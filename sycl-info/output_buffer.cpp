@@ -0,0 +1,101 @@
+////////////////////////////////////////////////////////////////////////////////
+// output_buffer.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "output_buffer.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <target_selector/scoped_timer.hpp>
+
+#ifdef _WIN32
+#include <io.h>
+#elif __unix__
+#include <unistd.h>
+#else
+#error "Not a windows/POSIX environment"
+#endif
+
+namespace sycl_info {
+
+/// @brief The size the buffer starts with; it doubles whenever it fills up
+///
+static constexpr std::size_t initial_buffer_size = 4 * 1024;
+
+output_buffer::output_buffer(int fd, std::size_t batchSize)
+    : fd_(fd), batchSize_(batchSize), buffer_(initial_buffer_size) {
+  setp(buffer_.data(), buffer_.data() + buffer_.size());
+}
+
+output_buffer::~output_buffer() { flush(); }
+
+#ifdef _WIN32
+static long write_some(int fd, const char* data, std::size_t size) {
+  return _write(fd, data, static_cast<unsigned int>(size));
+}
+#else
+static long write_some(int fd, const char* data, std::size_t size) {
+  return ::write(fd, data, size);
+}
+#endif
+
+bool output_buffer::flush() {
+  target_selector::scoped_timer timer{"write output"};
+  const char* data = pbase();
+  auto size = static_cast<std::size_t>(pptr() - pbase());
+  bool written = true;
+  while (size != 0) {
+    const auto result = write_some(fd_, data, size);
+    if (result < 0 && errno == EINTR) {
+      continue;
+    }
+    if (result <= 0) {
+      written = false;
+      break;
+    }
+    data += result;
+    size -= static_cast<std::size_t>(result);
+  }
+
+  // Output that could not be written is dropped, as std::cout would do
+  setp(buffer_.data(), buffer_.data() + buffer_.size());
+  return written;
+}
+
+output_buffer::int_type output_buffer::overflow(int_type ch) {
+  const auto used = static_cast<std::size_t>(pptr() - pbase());
+  if (batchSize_ != 0 && used >= batchSize_) {
+    if (!flush()) {
+      return traits_type::eof();
+    }
+  } else {
+    buffer_.resize(std::max(buffer_.size() * 2, initial_buffer_size));
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+    pbump(static_cast<int>(used));
+  }
+
+  if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+    *pptr() = traits_type::to_char_type(ch);
+    pbump(1);
+  }
+  return traits_type::not_eof(ch);
+}
+
+int output_buffer::sync() { return flush() ? 0 : -1; }
+
+}  // namespace sycl_info
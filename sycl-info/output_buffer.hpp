@@ -0,0 +1,73 @@
+////////////////////////////////////////////////////////////////////////////////
+// output_buffer.hpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SYCL_INFO_OUTPUT_BUFFER_HPP
+#define SYCL_INFO_OUTPUT_BUFFER_HPP
+
+#include <cstddef>
+#include <streambuf>
+#include <vector>
+
+namespace sycl_info {
+
+/// @brief The amount of output that is held before it is written out, unless
+/// the output ends first
+///
+constexpr std::size_t output_batch_size = 64 * 1024;
+
+/// @brief Collects everything written to it in a single growable buffer and
+/// writes it to a file descriptor with one system call per batch. Short
+/// outputs are written once, when the buffer is flushed.
+///
+/// This is a std::streambuf, so the functions that print to a std::ostream
+/// can write to it through a std::ostream constructed over it.
+///
+class output_buffer : public std::streambuf {
+ public:
+  /// @brief Buffers output for a file descriptor, e.g. 1 for stdout
+  /// @param The file descriptor and the size of the batches to write. A
+  /// batch size of 0 holds the whole output until flush() is called.
+  ///
+  explicit output_buffer(int fd, std::size_t batchSize = output_batch_size);
+
+  output_buffer(const output_buffer&) = delete;
+  output_buffer& operator=(const output_buffer&) = delete;
+
+  /// @brief Writes out whatever is left in the buffer
+  ///
+  ~output_buffer() override;
+
+  /// @brief Writes the buffered output to the file descriptor
+  /// @return false if the output could not be written
+  ///
+  bool flush();
+
+ protected:
+  int_type overflow(int_type ch) override;
+  int sync() override;
+
+ private:
+  int fd_;
+  std::size_t batchSize_;
+  std::vector<char> buffer_;
+};
+
+}  // namespace sycl_info
+
+#endif  // SYCL_INFO_OUTPUT_BUFFER_HPP
@@ -0,0 +1,267 @@
+////////////////////////////////////////////////////////////////////////////////
+// record_writer.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "record_writer.hpp"
+
+#include "impl_finder.hpp"
+#include <target_selector/target_selector.hpp>
+
+namespace sycl_info {
+
+output_format parse_output_format(const std::string& format) {
+  if (format.empty() || format == "text") {
+    return output_format::text;
+  }
+  if (format == "json") {
+    return output_format::json;
+  }
+  if (format == "ndjson") {
+    return output_format::ndjson;
+  }
+  throw target_selector::sycl_info_error{"Unknown output format " + format +
+                                         " (expected text, json or ndjson)"};
+}
+
+void json_writer::separate() {
+  if (afterKey_) {
+    afterKey_ = false;
+    return;
+  }
+  if (!hasElements_.empty()) {
+    if (hasElements_.back()) {
+      out_ << ',';
+    }
+    hasElements_.back() = true;
+  }
+}
+
+void json_writer::write_string(const std::string& str) {
+  constexpr const char* digits = "0123456789abcdef";
+  out_ << '"';
+  for (const auto c : str) {
+    switch (c) {
+      case '"':
+        out_ << "\\\"";
+        break;
+      case '\\':
+        out_ << "\\\\";
+        break;
+      case '\n':
+        out_ << "\\n";
+        break;
+      case '\r':
+        out_ << "\\r";
+        break;
+      case '\t':
+        out_ << "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          out_ << "\\u00" << digits[(c >> 4) & 0xf] << digits[c & 0xf];
+        } else {
+          out_ << c;
+        }
+    }
+  }
+  out_ << '"';
+}
+
+json_writer& json_writer::begin_object() {
+  separate();
+  out_ << '{';
+  hasElements_.push_back(false);
+  return *this;
+}
+
+json_writer& json_writer::end_object() {
+  out_ << '}';
+  hasElements_.pop_back();
+  return *this;
+}
+
+json_writer& json_writer::begin_array() {
+  separate();
+  out_ << '[';
+  hasElements_.push_back(false);
+  return *this;
+}
+
+json_writer& json_writer::end_array() {
+  out_ << ']';
+  hasElements_.pop_back();
+  return *this;
+}
+
+json_writer& json_writer::key(const char* name) {
+  separate();
+  write_string(name);
+  out_ << ':';
+  afterKey_ = true;
+  return *this;
+}
+
+json_writer& json_writer::value(const std::string& str) {
+  separate();
+  write_string(str);
+  return *this;
+}
+
+json_writer& json_writer::value(std::size_t number) {
+  separate();
+  out_ << number;
+  return *this;
+}
+
+void json_writer::end_document() { out_ << '\n'; }
+
+/// @brief Writes a field of a syclinfo file, which is expected to be a string
+///
+static void write_field(json_writer& writer, const char* name,
+                        const nlohmann::json& field) {
+  writer.key(name).value(field.is_string() ? field.get<std::string>()
+                                           : field.dump());
+}
+
+static void write_impl(json_writer& writer, std::size_t index,
+                       const nlohmann::json& impl) {
+  writer.begin_object();
+  writer.key("index").value(index);
+  write_field(writer, "name", impl["name"]);
+  write_field(writer, "version", impl["version"]);
+  write_field(writer, "vendor", impl["vendor"]);
+  // Every path the file was found at; implementations compiled into
+  // sycl-info have none
+  const auto sources = impl.find("source_paths");
+  if (sources != impl.end() && sources->is_array()) {
+    writer.key("source_paths").begin_array();
+    for (const auto& source : *sources) {
+      writer.value(source.get<std::string>());
+    }
+    writer.end_array();
+  }
+  writer.end_object();
+}
+
+void write_impls(const std::vector<nlohmann::json>& implementations,
+                 output_format format, std::ostream& out) {
+  target_selector::scoped_timer timer{"format output"};
+  json_writer writer{out};
+  switch (format) {
+    case output_format::text:
+      dump_impls(implementations, out);
+      break;
+    case output_format::json:
+      writer.begin_object().key("implementations").begin_array();
+      for (std::size_t i = 0; i < implementations.size(); ++i) {
+        write_impl(writer, i + 1, implementations[i]);
+      }
+      writer.end_array().end_object().end_document();
+      break;
+    case output_format::ndjson:
+      for (std::size_t i = 0; i < implementations.size(); ++i) {
+        write_impl(writer, i + 1, implementations[i]);
+        writer.end_document();
+      }
+      break;
+  }
+}
+
+/// @brief Writes the members of a platform, except for its devices
+///
+static void write_platform_members(json_writer& writer, const char* indexKey,
+                                   std::size_t index,
+                                   const using_target_matcher::platform& plat) {
+  writer.key(indexKey).value(index);
+  writer.key(select<selections::plat_name>::value).value(plat.name);
+  writer.key(select<selections::plat_vendor>::value).value(plat.vendor);
+}
+
+static void write_device_members(json_writer& writer, const char* indexKey,
+                                 std::size_t index,
+                                 const using_target_matcher::device& dev) {
+  writer.key(indexKey).value(index);
+  writer.key(select<selections::dev_name>::value).value(dev.name);
+  writer.key(select<selections::dev_vendor>::value).value(dev.vendor);
+  writer.key(select<selections::dev_type>::value).value(dev.type);
+  writer.key(select<selections::supported_drivers>::value).begin_array();
+  for (const auto& driver : dev.drivers) {
+    writer.value(driver);
+  }
+  writer.end_array();
+}
+
+void write_picked_impl(const using_target_matcher::print_type& platforms,
+                       output_format format, std::ostream& out) {
+  target_selector::scoped_timer timer{"format output"};
+  json_writer writer{out};
+  std::size_t platformIndex = 1;
+  switch (format) {
+    case output_format::text:
+      dump_picked_impl(platforms, out);
+      break;
+    case output_format::json:
+      writer.begin_object().key("platforms").begin_array();
+      for (const auto& plat : platforms) {
+        writer.begin_object();
+        write_platform_members(writer, "index", platformIndex++, plat);
+        writer.key("devices").begin_array();
+        std::size_t deviceIndex = 1;
+        for (const auto& dev : plat.devices) {
+          writer.begin_object();
+          write_device_members(writer, "index", deviceIndex++, dev);
+          writer.end_object();
+        }
+        writer.end_array().end_object();
+      }
+      writer.end_array().end_object().end_document();
+      break;
+    case output_format::ndjson:
+      // One record per device, so platforms without devices are left out
+      for (const auto& plat : platforms) {
+        std::size_t deviceIndex = 1;
+        for (const auto& dev : plat.devices) {
+          writer.begin_object();
+          write_platform_members(writer, "platform_index", platformIndex,
+                                 plat);
+          write_device_members(writer, "device_index", deviceIndex++, dev);
+          writer.end_object().end_document();
+        }
+        ++platformIndex;
+      }
+      break;
+  }
+}
+
+void write_config(const backend_info& info, output_format format,
+                  std::ostream& out) {
+  target_selector::scoped_timer timer{"format output"};
+  if (format == output_format::text) {
+    dump_config(info, out);
+    return;
+  }
+
+  // A single record is the same in json and ndjson
+  json_writer writer{out};
+  writer.begin_object();
+  writer.key(select<selections::backend>::value).value(info.backend);
+  writer.key(select<selections::dev_flags>::value).value(info.deviceFlags);
+  writer.end_object().end_document();
+}
+
+}  // namespace sycl_info
@@ -0,0 +1,103 @@
+////////////////////////////////////////////////////////////////////////////////
+// record_writer.hpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SYCL_INFO_RECORD_WRITER_HPP
+#define SYCL_INFO_RECORD_WRITER_HPP
+
+#include "impl_matchers.hpp"
+#include <cstddef>
+#include <nlohmann/json.hpp>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace sycl_info {
+
+/// @brief The formats results can be written in
+///
+enum class output_format {
+  /// @brief Human readable text
+  text,
+  /// @brief A single json document
+  json,
+  /// @brief One json document per line, one line per record
+  ndjson
+};
+
+/// @brief Converts the value of --format to an output_format
+/// @throws target_selector::sycl_info_error if the format is unknown
+///
+output_format parse_output_format(const std::string& format);
+
+/// @brief Writes json straight to a stream as it is produced, without
+/// building a document first. The caller is responsible for producing well
+/// formed json, e.g. by calling key() before each value of an object.
+///
+class json_writer {
+ public:
+  explicit json_writer(std::ostream& out) : out_(out) {}
+
+  json_writer& begin_object();
+  json_writer& end_object();
+  json_writer& begin_array();
+  json_writer& end_array();
+
+  /// @brief Writes the key of the next member of an object
+  ///
+  json_writer& key(const char* name);
+
+  json_writer& value(const std::string& str);
+  json_writer& value(std::size_t number);
+
+  /// @brief Ends the current document with a new line, e.g. to separate the
+  /// records of ndjson
+  ///
+  void end_document();
+
+ private:
+  /// @brief Writes the separator needed before a value or a key
+  ///
+  void separate();
+  void write_string(const std::string& str);
+
+  std::ostream& out_;
+  /// @brief Whether each open object/array has any elements yet
+  std::vector<bool> hasElements_;
+  bool afterKey_ = false;
+};
+
+/// @brief Writes the SYCL implementations found in the given format
+///
+void write_impls(const std::vector<nlohmann::json>& implementations,
+                 output_format format, std::ostream& out);
+
+/// @brief Writes the platforms/devices matched with an implementation in the
+/// given format. The indices match the ones accepted by --config.
+///
+void write_picked_impl(const using_target_matcher::print_type& platforms,
+                       output_format format, std::ostream& out);
+
+/// @brief Writes the backend of a configuration in the given format
+///
+void write_config(const backend_info& info, output_format format,
+                  std::ostream& out);
+
+}  // namespace sycl_info
+
+#endif  // SYCL_INFO_RECORD_WRITER_HPP
@@ -0,0 +1,379 @@
+////////////////////////////////////////////////////////////////////////////////
+// shared_catalog.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "shared_catalog.hpp"
+
+#include "batched_io.hpp"
+#include "config.hpp"
+#include "utility.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <target_selector/target_selector.hpp>
+#include <thread>
+
+#ifdef __unix__
+#include <cerrno>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace sycl_info {
+
+/// \brief Changed whenever the layout of the segments changes
+///
+constexpr std::uint32_t segment_format = 1;
+
+bool shared_catalog_enabled() {
+#ifdef __unix__
+  return target_selector::getenv_variable("SYCL_INFO_SHARED_CATALOG") == "1";
+#else
+  return false;
+#endif
+}
+
+std::uint64_t catalog_fingerprint(const std::vector<std::string>& files) {
+  fnv1a_hash hash;
+  hash.update(SYCL_INFO_VERSION);
+  hash.update(std::to_string(segment_format));
+  update_stamps(hash, files);
+  return hash.value();
+}
+
+namespace {
+/// \brief The start of a segment. It is followed by one segment_entry per
+/// implementation, then by the name and the MessagePack encoding of each
+/// implementation.
+///
+struct segment_header {
+  char magic[8];
+  std::uint32_t format;
+  /// \brief Set to 1, last, once the segment has been written
+  std::uint32_t ready;
+  std::uint64_t fingerprint;
+  std::uint64_t size;
+  /// \brief The process writing the segment, and when it started
+  std::uint64_t creator;
+  std::int64_t created;
+  std::uint64_t impls;
+};
+
+struct segment_entry {
+  std::uint64_t nameOffset;
+  std::uint64_t nameSize;
+  std::uint64_t offset;
+  std::uint64_t size;
+};
+
+constexpr char segment_magic[8] = {'S', 'Y', 'C', 'L', 'C', 'A', 'T', '\0'};
+
+const segment_entry* entries(const unsigned char* data) noexcept {
+  return reinterpret_cast<const segment_entry*>(data +
+                                                sizeof(segment_header));
+}
+}  // namespace
+
+std::size_t shared_catalog::size() const noexcept {
+  return reinterpret_cast<const segment_header*>(data_)->impls;
+}
+
+bool shared_catalog::has_name(std::size_t index,
+                              const std::string& name) const noexcept {
+  const auto& entry = entries(data_)[index];
+  return entry.nameSize == name.size() &&
+         std::memcmp(data_ + entry.nameOffset, name.data(), name.size()) == 0;
+}
+
+nlohmann::json shared_catalog::load(std::size_t index) const {
+  target_selector::scoped_timer timer{"decode shared catalog"};
+  const auto& entry = entries(data_)[index];
+  const auto* first = data_ + entry.offset;
+  return nlohmann::json::from_msgpack(first, first + entry.size);
+}
+
+std::vector<nlohmann::json> shared_catalog::load_all() const {
+  auto impls = std::vector<nlohmann::json>{};
+  impls.reserve(size());
+  for (std::size_t i = 0; i < size(); ++i) {
+    impls.push_back(load(i));
+  }
+  return impls;
+}
+
+#ifdef __unix__
+/// \brief How long a segment may stay without a header before it is
+/// considered abandoned by a process that was killed while creating it
+///
+constexpr std::time_t abandoned_after = 60;
+
+/// \brief How long a process waits for the catalog another process is
+/// publishing before parsing it itself
+///
+constexpr std::chrono::seconds publisher_timeout{10};
+
+std::string shared_catalog_name(const std::vector<std::string>& paths,
+                                const search_options& options) {
+  fnv1a_hash hash;
+  hash.update(SYCL_INFO_VERSION);
+  for (const auto& path : paths) {
+    hash.update(path);
+  }
+  hash.update(std::to_string(options.depth));
+  for (const auto& pattern : options.prune) {
+    hash.update(pattern);
+  }
+  return "/sycl-info-" + std::to_string(geteuid()) + '-' + hash.hex();
+}
+
+/// \brief Removes a segment that is out of date, unless it has already been
+/// replaced by another process. The check and the removal are not atomic: at
+/// worst a segment that was just published is removed, and published again
+/// by the next process.
+///
+static void remove_segment(const std::string& name, int fd) {
+  struct stat ours;
+  struct stat current;
+  const auto currentFd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (currentFd < 0) {
+    return;
+  }
+  if (fstat(fd, &ours) == 0 && fstat(currentFd, &current) == 0 &&
+      ours.st_ino == current.st_ino) {
+    shm_unlink(name.c_str());
+  }
+  close(currentFd);
+}
+
+namespace {
+enum class attach_status { attached, missing, publishing, out_of_date };
+}  // namespace
+
+/// \brief Maps a segment if it holds the catalog with the given fingerprint
+///
+static attach_status try_attach(const std::string& name,
+                                std::uint64_t fingerprint,
+                                const unsigned char*& data, std::size_t& size) {
+  const auto fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return attach_status::missing;
+  }
+  auto status = attach_status::out_of_date;
+  void* mapped = MAP_FAILED;
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_uid != geteuid() ||
+      (info.st_mode & (S_IWGRP | S_IWOTH))) {
+    // Not removed: it is not ours
+    close(fd);
+    return attach_status::missing;
+  }
+
+  size = static_cast<std::size_t>(info.st_size);
+  if (size < sizeof(segment_header)) {
+    // The header is written right after the segment is created
+    status = std::time(nullptr) - info.st_mtime > abandoned_after
+                 ? attach_status::out_of_date
+                 : attach_status::publishing;
+  } else {
+    mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  if (mapped != MAP_FAILED) {
+    data = static_cast<const unsigned char*>(mapped);
+    const auto& header = *reinterpret_cast<const segment_header*>(data);
+    const auto ready = __atomic_load_n(&header.ready, __ATOMIC_ACQUIRE);
+    const auto creator = static_cast<pid_t>(header.creator);
+    if (std::memcmp(header.magic, segment_magic, 8) != 0 ||
+        header.format != segment_format) {
+      status = attach_status::out_of_date;
+    } else if (!ready) {
+      // Abandoned if the process publishing it has died
+      status = kill(creator, 0) != 0 && errno == ESRCH
+                   ? attach_status::out_of_date
+                   : attach_status::publishing;
+    } else if (header.fingerprint == fingerprint && header.size == size &&
+               header.impls <= (size - sizeof(segment_header)) /
+                                   sizeof(segment_entry)) {
+      status = attach_status::attached;
+      for (std::uint64_t i = 0; i < header.impls; ++i) {
+        const auto& entry = entries(data)[i];
+        if (entry.nameOffset > size ||
+            entry.nameSize > size - entry.nameOffset || entry.offset > size ||
+            entry.size > size - entry.offset) {
+          status = attach_status::out_of_date;
+        }
+      }
+    }
+  }
+
+  if (status == attach_status::out_of_date) {
+    // The vendor files changed since it was published
+    remove_segment(name, fd);
+  }
+  if (status != attach_status::attached && mapped != MAP_FAILED) {
+    munmap(mapped, size);
+  }
+  close(fd);
+  return status;
+}
+
+std::unique_ptr<shared_catalog> shared_catalog::attach(
+    const std::vector<std::string>& paths, const search_options& options,
+    std::uint64_t fingerprint, bool wait) {
+  target_selector::scoped_timer timer{"attach shared catalog"};
+  const auto name = shared_catalog_name(paths, options);
+  const auto deadline = std::chrono::steady_clock::now() + publisher_timeout;
+  auto delay = std::chrono::milliseconds{1};
+  const unsigned char* data = nullptr;
+  auto size = std::size_t{0};
+  for (;;) {
+    const auto status = try_attach(name, fingerprint, data, size);
+    if (status == attach_status::attached) {
+      return std::unique_ptr<shared_catalog>{new shared_catalog{data, size}};
+    }
+    if (!wait || status != attach_status::publishing ||
+        std::chrono::steady_clock::now() >= deadline) {
+      return nullptr;
+    }
+    std::this_thread::sleep_for(delay);
+    delay = std::min(delay * 2, std::chrono::milliseconds{50});
+  }
+}
+
+shared_catalog::~shared_catalog() {
+  munmap(const_cast<unsigned char*>(data_), size_);
+}
+
+std::unique_ptr<shared_catalog_writer> shared_catalog_writer::claim(
+    const std::vector<std::string>& paths, const search_options& options) {
+  auto name = shared_catalog_name(paths, options);
+  // Only one process creates the segment; the others wait for it to be
+  // published
+  const auto fd =
+      shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+  if (fd < 0) {
+    return nullptr;
+  }
+  std::unique_ptr<shared_catalog_writer> writer{
+      new shared_catalog_writer{std::move(name), fd}};
+
+  // The header tells the other processes who is publishing the catalog
+  auto* mapped =
+      ftruncate(fd, sizeof(segment_header)) == 0
+          ? mmap(nullptr, sizeof(segment_header), PROT_READ | PROT_WRITE,
+                 MAP_SHARED, fd, 0)
+          : MAP_FAILED;
+  if (mapped == MAP_FAILED) {
+    return nullptr;
+  }
+  auto& header = *static_cast<segment_header*>(mapped);
+  std::memcpy(header.magic, segment_magic, sizeof(segment_magic));
+  header.format = segment_format;
+  header.creator = static_cast<std::uint64_t>(getpid());
+  header.created = static_cast<std::int64_t>(std::time(nullptr));
+  munmap(mapped, sizeof(segment_header));
+  return writer;
+}
+
+void shared_catalog_writer::publish(
+    std::uint64_t fingerprint,
+    const std::vector<nlohmann::json>& impls) noexcept {
+  target_selector::scoped_timer timer{"publish shared catalog"};
+  try {
+    auto names = std::vector<std::string>{};
+    auto encoded = std::vector<std::vector<std::uint8_t>>{};
+    auto size = sizeof(segment_header) + impls.size() * sizeof(segment_entry);
+    for (const auto& impl : impls) {
+      const auto it = impl.find("name");
+      names.push_back(it != impl.end() && it->is_string()
+                          ? it->get<std::string>()
+                          : std::string{});
+      encoded.push_back(nlohmann::json::to_msgpack(impl));
+      size += names.back().size() + encoded.back().size();
+    }
+
+    auto* mapped = ftruncate(fd_, static_cast<off_t>(size)) == 0
+                       ? mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                              MAP_SHARED, fd_, 0)
+                       : MAP_FAILED;
+    if (mapped == MAP_FAILED) {
+      return;
+    }
+    auto* data = static_cast<unsigned char*>(mapped);
+    auto& header = *reinterpret_cast<segment_header*>(data);
+    header.fingerprint = fingerprint;
+    header.size = size;
+    header.impls = impls.size();
+
+    auto* entry = reinterpret_cast<segment_entry*>(data + sizeof(header));
+    auto offset = sizeof(header) + impls.size() * sizeof(segment_entry);
+    for (std::size_t i = 0; i < impls.size(); ++i, ++entry) {
+      entry->nameOffset = offset;
+      entry->nameSize = names[i].size();
+      std::memcpy(data + offset, names[i].data(), names[i].size());
+      offset += names[i].size();
+      entry->offset = offset;
+      entry->size = encoded[i].size();
+      std::memcpy(data + offset, encoded[i].data(), encoded[i].size());
+      offset += encoded[i].size();
+    }
+    // Everything else is visible to a process that sees ready set
+    __atomic_store_n(&header.ready, 1u, __ATOMIC_RELEASE);
+    munmap(mapped, size);
+    fchmod(fd_, S_IRUSR);
+    published_ = true;
+  } catch (...) {
+    // Not shared then: the destructor removes the segment
+  }
+}
+
+shared_catalog_writer::~shared_catalog_writer() {
+  if (!published_) {
+    shm_unlink(name_.c_str());
+  }
+  close(fd_);
+}
+#else
+std::string shared_catalog_name(const std::vector<std::string>&,
+                                const search_options&) {
+  return std::string{};
+}
+
+std::unique_ptr<shared_catalog> shared_catalog::attach(
+    const std::vector<std::string>&, const search_options&, std::uint64_t,
+    bool) {
+  return nullptr;
+}
+
+shared_catalog::~shared_catalog() = default;
+
+std::unique_ptr<shared_catalog_writer> shared_catalog_writer::claim(
+    const std::vector<std::string>&, const search_options&) {
+  return nullptr;
+}
+
+void shared_catalog_writer::publish(
+    std::uint64_t, const std::vector<nlohmann::json>&) noexcept {}
+
+shared_catalog_writer::~shared_catalog_writer() = default;
+#endif  // __unix__
+
+}  // namespace sycl_info
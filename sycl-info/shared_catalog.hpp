@@ -0,0 +1,140 @@
+////////////////////////////////////////////////////////////////////////////////
+// shared_catalog.hpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SYCL_INFO_SHARED_CATALOG_HPP
+#define SYCL_INFO_SHARED_CATALOG_HPP
+
+#include "impl_finder.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace sycl_info {
+
+/// \brief Checks if the catalogs are shared between processes, which is
+/// requested by setting the environment variable SYCL_INFO_SHARED_CATALOG to
+/// 1. POSIX only.
+///
+bool shared_catalog_enabled();
+
+/// \brief Computes the fingerprint of the version of a catalog: the paths,
+/// identities, sizes and modification times of its files. The files are
+/// queried as one batch but not read.
+///
+std::uint64_t catalog_fingerprint(const std::vector<std::string>& files);
+
+/// \brief Names the shared memory segment of a list of directories. The name
+/// includes the user, so that no other user can publish a catalog for
+/// sycl-info to read.
+///
+std::string shared_catalog_name(const std::vector<std::string>& paths,
+                                const search_options& options);
+
+/// \brief A catalog published in a named, read-only shared memory segment
+/// by the first sycl-info that parsed it, so that the processes started at
+/// the same time (e.g. by a parallel build) do not all parse it again.
+///
+/// The segment is named after the user and the directories searched, and
+/// holds the fingerprint of the catalog it was made from: a process that
+/// finds it out of date removes it, and publishes it again. It is mapped,
+/// not copied: only the implementations that are loaded are decoded.
+///
+class shared_catalog {
+ public:
+  /// \brief Attaches to the segment of a list of directories
+  /// \param wait whether to wait, for a few seconds at most, for a segment
+  /// that another process is publishing
+  /// \returns nullptr if there is no segment, if it is out of date or still
+  /// being published, or if it does not belong to the current user
+  ///
+  static std::unique_ptr<shared_catalog> attach(
+      const std::vector<std::string>& paths, const search_options& options,
+      std::uint64_t fingerprint, bool wait = false);
+
+  ~shared_catalog();
+
+  shared_catalog(const shared_catalog&) = delete;
+  shared_catalog& operator=(const shared_catalog&) = delete;
+
+  /// \brief The number of implementations in the catalog
+  ///
+  std::size_t size() const noexcept;
+
+  /// \brief Checks the name of the index-th implementation (from 0) without
+  /// decoding it
+  ///
+  bool has_name(std::size_t index, const std::string& name) const noexcept;
+
+  /// \brief Decodes the index-th implementation (from 0)
+  ///
+  nlohmann::json load(std::size_t index) const;
+
+  /// \brief Decodes every implementation
+  ///
+  std::vector<nlohmann::json> load_all() const;
+
+ private:
+  shared_catalog(const unsigned char* data, std::size_t size) noexcept
+      : data_(data), size_(size) {}
+
+  const unsigned char* data_;
+  std::size_t size_;
+};
+
+/// \brief The right to publish the catalog of a list of directories. Only
+/// one process holds it at a time; the others wait for the catalog to be
+/// published (see shared_catalog::attach()).
+///
+class shared_catalog_writer {
+ public:
+  /// \brief Creates the segment of a list of directories
+  /// \returns nullptr if another process has created it first
+  ///
+  static std::unique_ptr<shared_catalog_writer> claim(
+      const std::vector<std::string>& paths, const search_options& options);
+
+  /// \brief Writes the catalog into the segment and makes it read-only.
+  /// Failures are ignored: the catalog is then simply not shared.
+  ///
+  void publish(std::uint64_t fingerprint,
+               const std::vector<nlohmann::json>& impls) noexcept;
+
+  /// \brief Removes the segment if it was not published
+  ///
+  ~shared_catalog_writer();
+
+  shared_catalog_writer(const shared_catalog_writer&) = delete;
+  shared_catalog_writer& operator=(const shared_catalog_writer&) = delete;
+
+ private:
+  shared_catalog_writer(std::string name, int fd) noexcept
+      : name_(std::move(name)), fd_(fd), published_(false) {}
+
+  std::string name_;
+  int fd_;
+  bool published_;
+};
+
+}  // namespace sycl_info
+
+#endif  // SYCL_INFO_SHARED_CATALOG_HPP
@@ -0,0 +1,239 @@
+////////////////////////////////////////////////////////////////////////////////
+// shared_hardware.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "shared_hardware.hpp"
+
+#include "config.hpp"
+#include "hardware_snapshot.hpp"
+#include "utility.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+#include <target_selector/target_selector.hpp>
+#include <thread>
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace sycl_info {
+
+bool shared_hardware_enabled() {
+#ifdef __unix__
+  return target_selector::getenv_variable("SYCL_INFO_SHARED_HARDWARE") == "1";
+#else
+  return false;
+#endif
+}
+
+/// \brief Enumerates the hardware through OpenCL
+///
+static using_target_matcher::print_type enumerate_hardware() {
+  target_selector::scoped_timer timer{"enumerate hardware"};
+  return capture_hardware();
+}
+
+#ifdef __unix__
+/// \brief How long a published enumeration is reused for
+///
+constexpr std::chrono::seconds reuse_window{2};
+
+/// \brief How long a process waits for the process enumerating the hardware
+/// before enumerating it itself
+///
+constexpr std::chrono::seconds enumeration_timeout{30};
+
+namespace {
+/// \brief Closes a file descriptor, which also releases its lock
+///
+struct file_descriptor {
+  int fd;
+
+  ~file_descriptor() {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+};
+}  // namespace
+
+/// \brief The path of the lock file and of the published snapshot, without
+/// their extensions. They are private to the user, and depend on the
+/// variables that select the OpenCL drivers the ICD loader sees.
+///
+static std::string shared_hardware_stem() {
+  auto directory = std::string{"/tmp"};
+  for (const auto* variable : {"XDG_RUNTIME_DIR", "TMPDIR"}) {
+    auto value = target_selector::getenv_variable(variable);
+    if (!value.empty()) {
+      directory = std::move(value);
+      break;
+    }
+  }
+
+  fnv1a_hash hash;
+  hash.update(SYCL_INFO_VERSION);
+  hash.update(std::to_string(snapshot_format_version));
+  for (const auto* variable : {"OCL_ICD_VENDORS", "OCL_ICD_FILENAMES"}) {
+    hash.update(target_selector::getenv_variable(variable));
+  }
+  return directory + "/sycl-info-" + std::to_string(geteuid()) +
+         "-hardware-" + hash.hex();
+}
+
+/// \brief Opens a file that belongs to the user and that no one else can
+/// write, without following symbolic links
+/// \returns -1 if there is no such file
+///
+static int open_private_file(const std::string& path, int flags) {
+  const auto fd = open(path.c_str(), flags | O_NOFOLLOW | O_CLOEXEC,
+                       S_IRUSR | S_IWUSR);
+  struct stat info;
+  if (fd >= 0 &&
+      (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) ||
+       info.st_uid != geteuid() || (info.st_mode & (S_IWGRP | S_IWOTH)))) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/// \brief Reads the hardware published by another process, if it was
+/// published recently enough to be reused
+///
+static bool read_published(const std::string& path,
+                           using_target_matcher::print_type& hardware) {
+  const file_descriptor file{open_private_file(path, O_RDONLY)};
+  struct stat info;
+  if (file.fd < 0 || fstat(file.fd, &info) != 0) {
+    return false;
+  }
+  const auto published = std::chrono::system_clock::time_point{
+      std::chrono::duration_cast<std::chrono::system_clock::duration>(
+          std::chrono::seconds{info.st_mtim.tv_sec} +
+          std::chrono::nanoseconds{info.st_mtim.tv_nsec})};
+  const auto age = std::chrono::system_clock::now() - published;
+  if (age > reuse_window || age < -reuse_window) {
+    return false;
+  }
+
+  auto contents = std::string{};
+  char buffer[4096];
+  for (auto n = read(file.fd, buffer, sizeof(buffer)); n != 0;
+       n = read(file.fd, buffer, sizeof(buffer))) {
+    if (n < 0) {
+      return false;
+    }
+    contents.append(buffer, static_cast<std::size_t>(n));
+  }
+  try {
+    std::istringstream in{contents};
+    hardware = read_snapshot(in);
+    return true;
+  } catch (std::exception&) {
+    // Truncated or from another version: enumerated again
+    return false;
+  }
+}
+
+/// \brief Publishes the hardware for the processes waiting for it. The file
+/// is replaced atomically, so it is never seen partially written. Failures
+/// are ignored: the hardware is then simply not shared.
+///
+static void publish(const std::string& path,
+                    const using_target_matcher::print_type& hardware) noexcept {
+  try {
+    std::ostringstream out;
+    write_snapshot(hardware, out);
+    const auto contents = out.str();
+
+    // mkstemp creates a file that did not exist (O_EXCL) and that only the
+    // user can access, so another user cannot have planted it or a link in
+    // its place
+    auto temporary = path + ".XXXXXX";
+    const file_descriptor file{mkstemp(&temporary[0])};
+    if (file.fd < 0) {
+      return;
+    }
+    fcntl(file.fd, F_SETFD, FD_CLOEXEC);
+    auto written = std::size_t{0};
+    while (written < contents.size()) {
+      const auto n = write(file.fd, contents.data() + written,
+                           contents.size() - written);
+      if (n <= 0) {
+        break;
+      }
+      written += static_cast<std::size_t>(n);
+    }
+    if (written != contents.size() ||
+        rename(temporary.c_str(), path.c_str()) != 0) {
+      unlink(temporary.c_str());
+    }
+  } catch (...) {
+  }
+}
+
+using_target_matcher::print_type shared_hardware() {
+  const auto stem = shared_hardware_stem();
+  const auto snapshot = stem + ".snapshot";
+  auto hardware = using_target_matcher::print_type{};
+  if (read_published(snapshot, hardware)) {
+    return hardware;
+  }
+
+  const file_descriptor lock{
+      open_private_file(stem + ".lock", O_RDWR | O_CREAT)};
+  if (lock.fd < 0) {
+    return enumerate_hardware();
+  }
+  auto locked = flock(lock.fd, LOCK_EX | LOCK_NB) == 0;
+  if (!locked) {
+    // Another process is enumerating the hardware. Its lock is released when
+    // it is done, or when it dies.
+    target_selector::scoped_timer timer{"wait for hardware"};
+    const auto deadline =
+        std::chrono::steady_clock::now() + enumeration_timeout;
+    auto delay = std::chrono::milliseconds{1};
+    while (!locked && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(delay);
+      delay = std::min(delay * 2, std::chrono::milliseconds{50});
+      locked = flock(lock.fd, LOCK_EX | LOCK_NB) == 0;
+    }
+  }
+
+  // Published by the process that held the lock, unless it died or timed out
+  if (!locked || !read_published(snapshot, hardware)) {
+    hardware = enumerate_hardware();
+    if (locked) {
+      publish(snapshot, hardware);
+    }
+  }
+  return hardware;
+}
+#else
+using_target_matcher::print_type shared_hardware() {
+  return enumerate_hardware();
+}
+#endif  // __unix__
+
+}  // namespace sycl_info
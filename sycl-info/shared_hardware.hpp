@@ -0,0 +1,50 @@
+////////////////////////////////////////////////////////////////////////////////
+// shared_hardware.hpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SYCL_INFO_SHARED_HARDWARE_HPP
+#define SYCL_INFO_SHARED_HARDWARE_HPP
+
+#include "impl_matchers.hpp"
+
+namespace sycl_info {
+
+/// \brief Checks if the hardware enumeration is shared between processes,
+/// which is requested by setting the environment variable
+/// SYCL_INFO_SHARED_HARDWARE to 1. POSIX only.
+///
+bool shared_hardware_enabled();
+
+/// \brief Enumerates every platform/device of the system once for all the
+/// sycl-info processes of a user that need it at the same time.
+///
+/// The first process to take the lock file of the hardware enumerates it
+/// (see capture_hardware()) and publishes it as a hardware snapshot; the
+/// others wait for the lock and read the snapshot instead of initializing
+/// OpenCL. The lock is released by the system if that process dies, and the
+/// next process takes over. A process that waits longer than a timeout
+/// enumerates the hardware itself.
+///
+/// A snapshot is only reused for a couple of seconds after it was published,
+/// so devices that are added or removed are seen by the next run.
+///
+using_target_matcher::print_type shared_hardware();
+
+}  // namespace sycl_info
+
+#endif  // SYCL_INFO_SHARED_HARDWARE_HPP
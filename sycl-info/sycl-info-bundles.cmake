@@ -0,0 +1,60 @@
+#[[  Copyright (C) Codeplay Software Limited.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+]]
+
+# Runs at install time. The installed sycl-info resolves every configuration
+# of the .syclinfo files it can find (see SYCL_VENDOR_PATHS) and writes one
+# CMake and one pkg-config file per implementation into the install tree.
+#
+# Expects (paths relative to the install prefix):
+#   SYCL_INFO_EXECUTABLE     the installed sycl-info
+#   SYCL_INFO_BUNDLE_DIR     where to install the CMake files
+#   SYCL_INFO_PKGCONFIG_DIR  where to install the pkg-config files
+#   SYCL_INFO_BUNDLE_HINT    optionally, another directory of .syclinfo files
+
+set(prefix "$ENV{DESTDIR}${CMAKE_INSTALL_PREFIX}")
+set(bundle_dir "${prefix}/${SYCL_INFO_BUNDLE_DIR}")
+set(pkgconfig_dir "${prefix}/${SYCL_INFO_PKGCONFIG_DIR}")
+file(MAKE_DIRECTORY "${bundle_dir}" "${pkgconfig_dir}")
+
+set(hint_args)
+if(SYCL_INFO_BUNDLE_HINT)
+    set(hint_args --hint "${SYCL_INFO_BUNDLE_HINT}")
+endif()
+
+execute_process(
+    COMMAND "${prefix}/${SYCL_INFO_EXECUTABLE}" ${hint_args}
+            --bundle-dir "${bundle_dir}"
+    RESULT_VARIABLE result
+    OUTPUT_VARIABLE written
+    ERROR_VARIABLE error
+)
+if(NOT result EQUAL 0)
+    message(WARNING "Unable to generate the sycl-info flag bundles: ${error}")
+    return()
+endif()
+
+# sycl-info prints the path of every file it writes
+string(REPLACE "\n" ";" written "${written}")
+foreach(file IN LISTS written)
+    if(file MATCHES "\\.pc$")
+        get_filename_component(name "${file}" NAME)
+        file(RENAME "${file}" "${pkgconfig_dir}/${name}")
+        set(file "${pkgconfig_dir}/${name}")
+    endif()
+    if(file)
+        message(STATUS "Installing: ${file}")
+        list(APPEND CMAKE_INSTALL_MANIFEST_FILES "${file}")
+    endif()
+endforeach()
@@ -12,4 +12,18 @@
  See the License for the specific language governing permissions and
  limitations under the License.
 ]]
+include(CMakeFindDependencyMacro)
+# Needed when the sycl_info library is static
+find_dependency(target-selector)
+find_dependency(nlohmann_json)
+find_dependency(Threads)
+
 include("${CMAKE_CURRENT_LIST_DIR}/sycl-info-targets.cmake")
+
+# Flag bundles generated at install time (SYCL_INFO_INSTALL_BUNDLES), which
+# provide the device flags of each implementation without running sycl-info
+file(GLOB sycl_info_bundles "${CMAKE_CURRENT_LIST_DIR}/bundles/*.cmake")
+foreach(sycl_info_bundle IN LISTS sycl_info_bundles)
+  include("${sycl_info_bundle}")
+endforeach()
+unset(sycl_info_bundles)
@@ -0,0 +1,171 @@
+#[[  Copyright (C) Codeplay Software Limited.
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+   http://www.apache.org/licenses/LICENSE-2.0
+
+ Unless required by applicable law or agreed to in writing, software
+ distributed under the License is distributed on an "AS IS" BASIS,
+ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ See the License for the specific language governing permissions and
+ limitations under the License.
+]]
+
+# Converts the .syclinfo files of a directory to the constexpr tables of
+# embedded_catalog.hpp.in, so that sycl-info has them without reading or
+# parsing any file. Reading JSON needs CMake 3.19.
+
+# Sets out to value as a C++ string literal
+function(sycl_info_string_literal out value)
+    string(REPLACE "\\" "\\\\" value "${value}")
+    string(REPLACE "\"" "\\\"" value "${value}")
+    string(REPLACE "\n" "\\n" value "${value}")
+    string(REPLACE "\r" "\\r" value "${value}")
+    string(REPLACE "\t" "\\t" value "${value}")
+    set(${out} "\"${value}\"" PARENT_SCOPE)
+endfunction()
+
+# Sets out to the member of a JSON object as a C++ string literal
+function(sycl_info_json_string out json file)
+    string(JSON value ERROR_VARIABLE error GET "${json}" ${ARGN})
+    if(error)
+        message(FATAL_ERROR "Unable to embed ${file}: ${error}")
+    endif()
+    sycl_info_string_literal(literal "${value}")
+    set(${out} "${literal}" PARENT_SCOPE)
+endfunction()
+
+# Sets out to the member of a JSON object as a C++ string literal, or to
+# default when the object has no such member
+function(sycl_info_json_optional_string out json file default)
+    string(JSON type ERROR_VARIABLE missing TYPE "${json}" ${ARGN})
+    if(missing)
+        sycl_info_string_literal(literal "${default}")
+    else()
+        sycl_info_json_string(literal "${json}" "${file}" ${ARGN})
+    endif()
+    set(${out} "${literal}" PARENT_SCOPE)
+endfunction()
+
+# Sets out to the number of elements of a JSON array
+function(sycl_info_json_length out json file)
+    string(JSON length ERROR_VARIABLE error LENGTH "${json}" ${ARGN})
+    if(error)
+        message(FATAL_ERROR "Unable to embed ${file}: ${error}")
+    endif()
+    set(${out} ${length} PARENT_SCOPE)
+endfunction()
+
+# Sets SYCL_INFO_EMBEDDED_TABLES, SYCL_INFO_EMBEDDED_IMPLS and
+# SYCL_INFO_EMBEDDED_COUNT for embedded_catalog.hpp.in
+function(sycl_info_embed_catalog directory)
+    if(CMAKE_VERSION VERSION_LESS 3.19)
+        message(FATAL_ERROR
+            "SYCL_INFO_EMBEDDED_CATALOG requires CMake 3.19 or newer")
+    endif()
+
+    file(GLOB files "${directory}/*.syclinfo")
+    list(SORT files)
+    # Reconfigure when one of the files changes
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${files})
+
+    set(tables "")
+    set(impls "")
+    set(impl_index 0)
+    foreach(file IN LISTS files)
+        file(READ "${file}" json)
+        set(impl "impl${impl_index}")
+        sycl_info_json_string(name "${json}" "${file}" name)
+        sycl_info_json_string(vendor "${json}" "${file}" vendor)
+        sycl_info_json_string(version "${json}" "${file}" version)
+
+        set(configs "")
+        sycl_info_json_length(config_count "${json}" "${file}"
+            supported_configurations)
+        set(config_index 0)
+        while(config_index LESS config_count)
+            set(conf "${impl}_config${config_index}")
+            set(path supported_configurations ${config_index})
+            foreach(field IN ITEMS platform_name platform_vendor
+                                   device_name device_vendor)
+                sycl_info_json_string(${field} "${json}" "${file}"
+                    ${path} ${field})
+            endforeach()
+            # As at runtime, a configuration without a device type supports
+            # every device type of its platform
+            sycl_info_json_optional_string(device_type "${json}" "${file}" ""
+                ${path} device_type)
+
+            sycl_info_json_length(driver_count "${json}" "${file}"
+                ${path} supported_drivers)
+            set(drivers "nullptr")
+            if(driver_count GREATER 0)
+                set(drivers "${conf}_drivers")
+                string(APPEND tables
+                    "constexpr const char* ${drivers}[] = {\n")
+                set(driver_index 0)
+                while(driver_index LESS driver_count)
+                    sycl_info_json_string(driver "${json}" "${file}"
+                        ${path} supported_drivers ${driver_index})
+                    string(APPEND tables "    ${driver},\n")
+                    math(EXPR driver_index "${driver_index} + 1")
+                endwhile()
+                string(APPEND tables "};\n")
+            endif()
+
+            sycl_info_json_length(target_count "${json}" "${file}"
+                ${path} supported_backend_targets)
+            set(targets "nullptr")
+            if(target_count GREATER 0)
+                set(targets "${conf}_targets")
+                string(APPEND tables
+                    "constexpr backend_target ${targets}[] = {\n")
+                set(target_index 0)
+                while(target_index LESS target_count)
+                    set(target_path
+                        ${path} supported_backend_targets ${target_index})
+                    sycl_info_json_string(backend "${json}" "${file}"
+                        ${target_path} backend_target)
+                    sycl_info_json_string(flags "${json}" "${file}"
+                        ${target_path} device_flags)
+                    string(APPEND tables "    {${backend}, ${flags}},\n")
+                    math(EXPR target_index "${target_index} + 1")
+                endwhile()
+                string(APPEND tables "};\n")
+            endif()
+
+            string(APPEND configs
+                "    {${platform_name}, ${platform_vendor}, ${device_type},\n"
+                "     ${device_name}, ${device_vendor},\n"
+                "     ${drivers}, ${driver_count}, ${targets}, "
+                "${target_count}},\n")
+            math(EXPR config_index "${config_index} + 1")
+        endwhile()
+
+        set(config_table "nullptr")
+        if(config_count GREATER 0)
+            set(config_table "${impl}_configs")
+            string(APPEND tables
+                "constexpr configuration ${config_table}[] = {\n"
+                "${configs}};\n")
+        endif()
+        string(APPEND impls
+            "    {${name}, ${vendor}, ${version}, ${config_table}, "
+            "${config_count}},\n")
+        math(EXPR impl_index "${impl_index} + 1")
+    endforeach()
+
+    if(impl_index GREATER 0)
+        string(APPEND tables
+            "constexpr implementation implementation_table[] = {\n"
+            "${impls}};\n")
+        set(SYCL_INFO_EMBEDDED_IMPLS "implementation_table" PARENT_SCOPE)
+    else()
+        message(WARNING "No .syclinfo files to embed in ${directory}")
+        set(SYCL_INFO_EMBEDDED_IMPLS "nullptr" PARENT_SCOPE)
+    endif()
+    set(SYCL_INFO_EMBEDDED_TABLES "${tables}" PARENT_SCOPE)
+    set(SYCL_INFO_EMBEDDED_COUNT ${impl_index} PARENT_SCOPE)
+endfunction()
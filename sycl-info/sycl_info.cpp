@@ -15,10 +15,25 @@
 //
 #include "config.hpp"
 
+#include "build_export.hpp"
 #include "cli_config.hpp"
+#include "flags_cache.hpp"
+#include "fleet_inventory.hpp"
+#include "hardware_snapshot.hpp"
+#include "impl_finder.hpp"
 #include "impl_matchers.hpp"
+#include "memory_report.hpp"
+#include "output_buffer.hpp"
+#include "record_writer.hpp"
+#include "shared_hardware.hpp"
+#include "target_planner.hpp"
+#include "timing_report.hpp"
 #include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <ostream>
 #include <stdexcept>
+#include <target_selector/target_selector.hpp>
 
 /// \brief Generates a configuration object.
 /// \returns A sycl_info::cli_config object containing the user options.
@@ -36,25 +51,75 @@ sycl_info::cli_config make_config(int argc, const char** argv) noexcept {
 /// \returns true if any command line options were given, false
 /// otherwise
 ///
-bool arguments_passed(int argc) {
+bool arguments_passed(int argc, std::ostream& out) {
   constexpr int noArguments = 1;
   if (argc == noArguments) {
-    sycl_info::print_impls(std::cout);
-    std::cout << std::flush;
+    sycl_info::print_impls(out);
     return false;
   }
   return true;
 }
 
+/// \brief Records the bytes held by a catalog for --memory-report, along with
+/// those its compact representation would hold
+///
+void report_catalog(const std::vector<nlohmann::json>& impls) {
+  if (!sycl_info::memory_report_enabled()) {
+    return;
+  }
+  sycl_info::record_footprint("catalog (json)", impls.size(),
+                              sycl_info::footprint(impls));
+  try {
+    auto compact = std::vector<sycl_info::compact_impl>{};
+    auto pool = sycl_info::backend_pool{};
+    for (const auto& impl : impls) {
+      compact.push_back(sycl_info::make_compact_impl(impl, pool));
+    }
+    sycl_info::record_footprint("catalog (compact)", compact.size(),
+                                sycl_info::footprint(compact));
+  } catch (nlohmann::json::exception&) {
+    // A file that does not follow the schema has no compact representation
+  }
+}
+
+/// \brief Records the bytes held by platforms/devices for --memory-report
+///
+void report_platforms(const std::string& structure,
+                      const sycl_info::using_target_matcher::print_type& found) {
+  if (sycl_info::memory_report_enabled()) {
+    sycl_info::record_footprint(structure, found.size(),
+                                sycl_info::footprint(found));
+  }
+}
+
+/// \brief Retrieves the hardware to match against: the snapshot given with
+/// --snapshot-in, or the hardware enumerated once for the concurrent sycl-info
+/// processes when it is shared
+/// \returns nullptr if the hardware is to be queried through OpenCL while it
+/// is matched
+///
+const sycl_info::using_target_matcher::print_type* get_hardware(
+    const sycl_info::cli_config& config,
+    sycl_info::using_target_matcher::print_type& snapshot) {
+  if (config.snapshot_in()) {
+    snapshot = sycl_info::load_snapshot(config.get_snapshot_in());
+  } else if (sycl_info::shared_hardware_enabled()) {
+    snapshot = sycl_info::shared_hardware();
+  } else {
+    return nullptr;
+  }
+  report_platforms("snapshot", snapshot);
+  return &snapshot;
+}
+
 /// \brief Returns the SYCL implementations available
 ///
 std::vector<nlohmann::json> get_sycl_info_impls(
     const sycl_info::cli_config& config) {
-  if (config.hint()) {
-    auto hint = config.get_hint();
-    return sycl_info::get_impls(std::move(hint));
-  }
-  return sycl_info::get_impls();
+  auto impls = config.hint() ? sycl_info::get_impls(config.get_hint())
+                             : sycl_info::get_impls();
+  report_catalog(impls);
+  return impls;
 }
 
 std::pair<int, int> get_index_from_config(const std::string& config) {
@@ -65,45 +130,221 @@ std::pair<int, int> get_index_from_config(const std::string& config) {
   return {platformIndex, deviceIndex};
 }
 
-void process_impl(const sycl_info::cli_config& config) {
+/// \brief The query made with --device-cflags, as cached
+///
+sycl_info::flags_query make_flags_query(const sycl_info::cli_config& config) {
+  auto query = sycl_info::flags_query{};
+  query.impl = config.get_impl();
+  query.config = config.get_config();
+  query.target = config.get_target();
+  query.all = config.all();
+  query.hint = config.hint() ? config.get_hint() : std::string{};
+  query.snapshot =
+      config.snapshot_in() ? config.get_snapshot_in() : std::string{};
+  return query;
+}
+
+void process_impl(const sycl_info::cli_config& config,
+                  const sycl_info::output_format format, std::ostream& out) {
   // sycl_info outputs starts from 1...N
   const std::string requestedImpl = config.get_impl();
 
-  const auto availableImpls = get_sycl_info_impls(config);
-  const auto implIndexQuery =
-      sycl_info::retrieve_index_for_impl(requestedImpl, availableImpls);
-  if (implIndexQuery.first) {
-    const int implIndex = implIndexQuery.second;
-    if (config.config() && config.device_compiler_flags()) {
-      sycl_info::print_config(implIndex, availableImpls,
-                              get_index_from_config(config.get_config()),
-                              config.get_target(), config.all(), std::cout);
+  // A cached query neither parses the catalog nor queries OpenCL
+  auto cached = std::unique_ptr<sycl_info::flags_cache_entry>{};
+  const auto cacheDirectory = sycl_info::flags_cache_directory();
+  if (!config.plan_targets() && config.config() &&
+      config.device_compiler_flags() && !cacheDirectory.empty()) {
+    cached.reset(new sycl_info::flags_cache_entry{cacheDirectory,
+                                                  make_flags_query(config)});
+    auto info = sycl_info::backend_info{};
+    if (cached->lookup(info)) {
+      sycl_info::write_config(info, format, out);
+      return;
+    }
+  }
+
+  // Only the requested implementation is loaded
+  const auto lookup = sycl_info::find_impl(
+      requestedImpl, config.hint() ? config.get_hint() : std::string{});
+  if (lookup.found) {
+    const auto availableImpls = std::vector<nlohmann::json>{lookup.impl};
+    constexpr unsigned int implIndex = 1;
+    report_catalog(availableImpls);
+
+    // A fleet brings its own hardware
+    auto snapshot = sycl_info::using_target_matcher::print_type{};
+    const auto* hardware = (config.plan_targets() && config.fleet())
+                               ? nullptr
+                               : get_hardware(config, snapshot);
+
+    if (config.plan_targets()) {
+      constexpr bool displayAll = false;
+      auto matched = sycl_info::using_target_matcher::print_type{};
+      if (config.fleet()) {
+        // Every device of every device set of the fleet has to be covered
+        const auto fleet = sycl_info::load_fleet(config.get_fleet());
+        for (const auto& set : fleet.deviceSets) {
+          report_platforms("snapshot", set.hardware);
+          for (const auto& plat : sycl_info::match_picked_impl(
+                   implIndex, availableImpls, displayAll, &set.hardware)) {
+            auto it = matched.insert(plat);
+            it.first->devices.insert(plat.devices.begin(), plat.devices.end());
+          }
+        }
+      } else {
+        matched = sycl_info::match_picked_impl(implIndex, availableImpls,
+                                               displayAll, hardware);
+      }
+      report_platforms("match results", matched);
+      sycl_info::dump_target_plan(
+          sycl_info::plan_targets(matched, availableImpls[implIndex - 1]),
+          out);
+    } else if (config.config() && config.device_compiler_flags()) {
+      const auto conf = sycl_info::get_config(
+          implIndex, availableImpls, get_index_from_config(config.get_config()),
+          config.all(), hardware);
+      if (!conf.platform.empty()) {
+        // sycl_info outputs starts from 1...N
+        const auto info = sycl_info::match_config_with_impls(
+            conf, availableImpls[implIndex - 1], config.get_target());
+        if (sycl_info::memory_report_enabled()) {
+          sycl_info::record_footprint("device flags", 1,
+                                      sycl_info::footprint(info));
+        }
+        if (cached) {
+          cached->store(info);
+        }
+        sycl_info::write_config(info, format, out);
+      }
     } else if (!config.config() && !config.device_compiler_flags()) {
-      sycl_info::print_picked_impl(implIndex, availableImpls, config.all(),
-                                   std::cout);
+      const auto matched = sycl_info::match_picked_impl(
+          implIndex, availableImpls, config.all(), hardware);
+      report_platforms("match results", matched);
+      sycl_info::write_picked_impl(matched, format, out);
     }
   } else {
-    // TBA error
+    throw target_selector::sycl_info_error{"No SYCL implementation " +
+                                           requestedImpl};
   }
 }
 
+/// \brief Exports the configurations of the implementation selected with
+/// --impl, or of every implementation, for a build system
+///
+void process_export(const sycl_info::cli_config& config, std::ostream& out) {
+  const auto format = sycl_info::parse_export_format(config.get_export());
+  const auto availableImpls = get_sycl_info_impls(config);
+
+  // sycl_info outputs starts from 1...N
+  auto indices = std::vector<unsigned int>{};
+  if (config.impl()) {
+    // Resolved as by process_impl(), so that --impl selects the same
+    // implementation with and without --export
+    const auto implIndex =
+        sycl_info::find_impl_index(config.get_impl(), availableImpls);
+    if (implIndex == 0) {
+      throw target_selector::sycl_info_error{"No SYCL implementation " +
+                                             config.get_impl()};
+    }
+    indices.push_back(implIndex);
+  } else {
+    for (unsigned int i = 1; i <= availableImpls.size(); ++i) {
+      indices.push_back(i);
+    }
+  }
+
+  auto snapshot = sycl_info::using_target_matcher::print_type{};
+  const auto* hardware = get_hardware(config, snapshot);
+
+  sycl_info::write_export(format, availableImpls, indices, hardware, out);
+}
+
 /// \brief Utility function that process the command line arguments passed
 ///
-void process_cli(sycl_info::cli_config config) {
-  if (config.hint() && !config.impl()) {
-    sycl_info::print_impls(std::cout, config.get_hint());
+void process_cli(sycl_info::cli_config config, std::ostream& out) {
+  const auto format = sycl_info::parse_output_format(config.get_format());
+  if (config.snapshot_out()) {
+    sycl_info::save_snapshot(config.get_snapshot_out());
+  } else if (config.fleet() && !config.plan_targets()) {
+    sycl_info::print_fleet(config.get_fleet(), get_sycl_info_impls(config),
+                           out);
+  } else if (config.bundle_dir()) {
+    for (const auto& path : sycl_info::write_bundles(
+             get_sycl_info_impls(config), config.get_bundle_dir())) {
+      out << path << '\n';
+    }
+  } else if (config.exporting()) {
+    process_export(config, out);
+  } else if (config.hint() && !config.impl()) {
+    sycl_info::write_impls(get_sycl_info_impls(config), format, out);
   } else if (config.help()) {
-    config.show_help(std::cout);
+    config.show_help(out);
   } else if (config.impl()) {
-    process_impl(config);
+    process_impl(config, format, out);
+  } else if (format != sycl_info::output_format::text) {
+    // The machine-readable equivalent of running without any options
+    sycl_info::write_impls(get_sycl_info_impls(config), format, out);
   }
+}
 
-  std::cout << std::flush;
+/// \brief Reports the phases timed while processing the command line, as
+/// requested with --timings and --trace
+///
+void report_timings(const sycl_info::cli_config& config) {
+  const auto events = target_selector::trace_events();
+  if (config.timings()) {
+    sycl_info::write_timings(events, std::cerr);
+  }
+  if (config.trace()) {
+    std::ofstream file{config.get_trace()};
+    if (!file) {
+      throw target_selector::sycl_info_error{"Unable to write trace " +
+                                             config.get_trace()};
+    }
+    sycl_info::write_chrome_trace(events, file);
+  }
 }
 
 int main(int argc, const char** argv) {
-  if (arguments_passed(argc)) {
-    process_cli(::make_config(argc, argv));
+  // Everything printed to stdout is formatted into one buffer and written
+  // with a single system call per batch
+  constexpr int stdoutDescriptor = 1;
+  sycl_info::output_buffer buffer{stdoutDescriptor};
+  std::ostream out{&buffer};
+
+  if (!arguments_passed(argc, out)) {
+    return buffer.flush() ? 0 : 1;
+  }
+
+  const auto config = ::make_config(argc, argv);
+  const bool timed = config.timings() || config.trace();
+  target_selector::enable_tracing(timed);
+  sycl_info::enable_memory_report(config.memory_report());
+  sycl_info::set_search_options(config.get_search_options());
+
+  int status = 0;
+  try {
+    target_selector::scoped_timer timer{"sycl-info"};
+    process_cli(config, out);
+    if (!buffer.flush()) {
+      status = 1;
+    }
+  } catch (std::exception& e) {
+    buffer.flush();
+    std::cerr << e.what() << '\n';
+    status = 1;
+  }
+
+  if (timed) {
+    try {
+      report_timings(config);
+    } catch (std::exception& e) {
+      std::cerr << e.what() << '\n';
+      status = 1;
+    }
+  }
+  if (config.memory_report()) {
+    sycl_info::write_memory_report(std::cerr);
   }
-  return 0;
+  return status;
 }
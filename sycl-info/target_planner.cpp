@@ -0,0 +1,231 @@
+////////////////////////////////////////////////////////////////////////////////
+// target_planner.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "target_planner.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+namespace sycl_info {
+
+static constexpr std::size_t bits_per_word = 64;
+
+static bool has_element(const cover_set& set, std::size_t element) {
+  return (set[element / bits_per_word] >> (element % bits_per_word)) & 1u;
+}
+
+static void add_element(cover_set& set, std::size_t element) {
+  set[element / bits_per_word] |= std::uint64_t{1}
+                                  << (element % bits_per_word);
+}
+
+static std::size_t count_elements(std::uint64_t word) {
+  auto count = std::size_t{0};
+  for (; word != 0; word &= word - 1) {
+    ++count;
+  }
+  return count;
+}
+
+// =============================================================================
+// Set cover is NP-hard, but the number of candidate backends is small in
+// practice: an implementation rarely lists more than a handful of them.
+// - With at most exact_cover_limit sets, every combination of k sets is tried
+//   for k = 1, 2, ..., so the first cover found uses the fewest sets. This
+//   takes O(2^n * n * w) for n sets of w words.
+// - Otherwise the set covering the most uncovered elements is picked until
+//   everything is covered, which is within a factor of ln(universe) of the
+//   optimum and takes O(n^2 * w).
+// =============================================================================
+std::vector<std::size_t> solve_set_cover(const std::vector<cover_set>& sets,
+                                         std::size_t universeSize,
+                                         bool& exact) {
+  const auto words = (universeSize + bits_per_word - 1) / bits_per_word;
+  auto coverable = cover_set(words);
+  for (const auto& set : sets) {
+    for (std::size_t w = 0; w < words; ++w) {
+      coverable[w] |= set[w];
+    }
+  }
+
+  auto picked = std::vector<std::size_t>{};
+  if (std::all_of(coverable.begin(), coverable.end(),
+                  [](std::uint64_t word) { return word == 0; })) {
+    exact = true;
+    return picked;
+  }
+
+  const auto n = sets.size();
+  if (n <= exact_cover_limit) {
+    exact = true;
+    auto covers = [&](std::uint32_t mask) {
+      auto covered = cover_set(words);
+      for (std::size_t i = 0; i < n; ++i) {
+        if (mask & (std::uint32_t{1} << i)) {
+          for (std::size_t w = 0; w < words; ++w) {
+            covered[w] |= sets[i][w];
+          }
+        }
+      }
+      return covered == coverable;
+    };
+
+    const auto limit = std::uint32_t{1} << n;
+    for (std::size_t k = 1; k <= n; ++k) {
+      // Visit every mask with k bits set in increasing order (Gosper's hack)
+      for (auto mask = (std::uint32_t{1} << k) - 1; mask < limit;) {
+        if (covers(mask)) {
+          for (std::size_t i = 0; i < n; ++i) {
+            if (mask & (std::uint32_t{1} << i)) {
+              picked.push_back(i);
+            }
+          }
+          return picked;
+        }
+        const auto lowest = mask & (~mask + 1);
+        const auto ripple = mask + lowest;
+        mask = (((ripple ^ mask) >> 2) / lowest) | ripple;
+      }
+    }
+  }
+
+  exact = false;
+  auto covered = cover_set(words);
+  while (covered != coverable) {
+    auto best = std::size_t{0};
+    auto bestGain = std::size_t{0};
+    for (std::size_t i = 0; i < n; ++i) {
+      auto gain = std::size_t{0};
+      for (std::size_t w = 0; w < words; ++w) {
+        gain += count_elements(sets[i][w] & ~covered[w]);
+      }
+      if (gain > bestGain) {
+        best = i;
+        bestGain = gain;
+      }
+    }
+
+    picked.push_back(best);
+    for (std::size_t w = 0; w < words; ++w) {
+      covered[w] |= sets[best][w];
+    }
+  }
+  std::sort(picked.begin(), picked.end());
+  return picked;
+}
+
+/// @brief Appends the flags of a device flags string that are not in flags
+/// already
+///
+static void append_flags(std::string& flags, const std::string& deviceFlags) {
+  std::istringstream newFlags{deviceFlags};
+  std::string flag;
+  while (newFlags >> flag) {
+    std::istringstream existingFlags{flags};
+    std::string existing;
+    bool found = false;
+    while (!found && existingFlags >> existing) {
+      found = (existing == flag);
+    }
+    if (!found) {
+      flags += flags.empty() ? flag : ' ' + flag;
+    }
+  }
+}
+
+target_plan plan_targets(const using_target_matcher::print_type& matched,
+                         const nlohmann::json& impl) {
+  using configs = select<selections::supported_configurations>;
+  using supported_backend = select<selections::supported_backend_targets>;
+  using backend = select<selections::backend>;
+
+  // The universe: every matched platform/device
+  auto devices = std::vector<config>{};
+  for (const auto& plat : matched) {
+    for (const auto& dev : plat.devices) {
+      devices.push_back(config{plat.name, dev.name});
+    }
+  }
+
+  // The candidates: every backend target listed by the implementation
+  auto backends = std::vector<std::string>{};
+  for (const auto& conf : impl[configs::value]) {
+    for (const auto& target : conf[supported_backend::value]) {
+      const auto name = target[backend::value].get<std::string>();
+      if (std::find(backends.begin(), backends.end(), name) ==
+          backends.end()) {
+        backends.push_back(name);
+      }
+    }
+  }
+
+  const auto words = (devices.size() + bits_per_word - 1) / bits_per_word;
+  auto sets = std::vector<cover_set>(backends.size(), cover_set(words));
+  for (std::size_t b = 0; b < backends.size(); ++b) {
+    for (std::size_t d = 0; d < devices.size(); ++d) {
+      if (!match_config_with_impls(devices[d], impl, backends[b])
+               .backend.empty()) {
+        add_element(sets[b], d);
+      }
+    }
+  }
+
+  target_plan plan;
+  const auto picked = solve_set_cover(sets, devices.size(), plan.exact);
+
+  // Each device uses the first picked backend that supports it
+  auto assigned = std::vector<bool>(devices.size());
+  for (const auto b : picked) {
+    auto target = backend_info{backends[b], {}};
+    for (std::size_t d = 0; d < devices.size(); ++d) {
+      if (has_element(sets[b], d) && !assigned[d]) {
+        assigned[d] = true;
+        const auto info =
+            match_config_with_impls(devices[d], impl, target.backend);
+        append_flags(target.deviceFlags, info.deviceFlags);
+        append_flags(plan.deviceFlags, info.deviceFlags);
+      }
+    }
+    plan.targets.push_back(std::move(target));
+  }
+
+  for (std::size_t d = 0; d < devices.size(); ++d) {
+    if (!assigned[d]) {
+      plan.uncovered.push_back(devices[d]);
+    }
+  }
+  return plan;
+}
+
+void dump_target_plan(const target_plan& plan, std::ostream& out) {
+  for (const auto& target : plan.targets) {
+    dump_config(target, out);
+  }
+  out << "Combined device flags: " << plan.deviceFlags << '\n';
+  if (!plan.exact) {
+    out << "Note: the back-ends were picked greedily and may not be the "
+           "fewest possible\n";
+  }
+  for (const auto& conf : plan.uncovered) {
+    out << "No back-end supports: " << conf.platform << " | " << conf.device
+        << '\n';
+  }
+}
+
+}  // namespace sycl_info
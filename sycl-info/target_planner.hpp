@@ -0,0 +1,81 @@
+////////////////////////////////////////////////////////////////////////////////
+// target_planner.hpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SYCL_INFO_TARGET_PLANNER_HPP
+#define SYCL_INFO_TARGET_PLANNER_HPP
+
+#include "impl_matchers.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace sycl_info {
+
+/// @brief The largest number of candidate backends for which the smallest
+/// cover is searched exhaustively. Larger problems are solved greedily.
+///
+constexpr std::size_t exact_cover_limit = 20;
+
+/// @brief A set of elements of a universe, one bit per element
+///
+using cover_set = std::vector<std::uint64_t>;
+
+/// @brief Picks the smallest number of sets whose union covers every element
+/// that any of the sets contains
+/// @param The sets to pick from, each with one bit per element of a universe
+/// of universeSize elements, and a flag that is set to whether the result is
+/// known to be minimal (exact search) or was picked greedily
+/// @return The indices of the picked sets, in increasing order
+///
+std::vector<std::size_t> solve_set_cover(const std::vector<cover_set>& sets,
+                                         std::size_t universeSize,
+                                         bool& exact);
+
+/// @brief The backend targets needed to cover a set of matched devices
+///
+struct target_plan {
+  /// @brief The chosen backends, each with the device flags of the
+  /// configurations it was chosen for
+  std::vector<backend_info> targets;
+  /// @brief The device flags of every chosen backend, without duplicates
+  std::string deviceFlags;
+  /// @brief The matched devices that no backend supports
+  std::vector<config> uncovered;
+  /// @brief Whether the plan is known to use the fewest backends
+  bool exact;
+};
+
+/// @brief Picks the fewest backend targets of an implementation that
+/// support every matched platform/device
+/// @param The platforms/devices matched with the implementation, e.g. by
+/// match_picked_impl(), and the syclinfo json of the implementation
+///
+target_plan plan_targets(const using_target_matcher::print_type& matched,
+                         const nlohmann::json& impl);
+
+/// @brief Prints a target plan to a stream
+///
+void dump_target_plan(const target_plan& plan, std::ostream& out);
+
+}  // namespace sycl_info
+
+#endif  // SYCL_INFO_TARGET_PLANNER_HPP
@@ -0,0 +1,189 @@
+////////////////////////////////////////////////////////////////////////////////
+// catalog_parser.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "catalog_parser.hpp"
+
+#include "test_utility.hpp"
+#include <cstddef>
+#include <cstdio>
+#include <doctest/doctest.h>
+#include <exception>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+/// \brief What a backend made of a file: its json, or the error it threw
+///
+struct parse_outcome {
+  bool parsed;
+  nlohmann::json impl;
+  std::string error;
+};
+
+parse_outcome parse_with(const std::string& contents,
+                         const sycl_info::parser_backend backend) {
+  try {
+    return {true, sycl_info::parse_catalog_file(contents, backend), {}};
+  } catch (std::exception& e) {
+    return {false, nlohmann::json{}, e.what()};
+  }
+}
+
+/// \brief Checks that both backends give the same json, or throw the same
+/// error, and that the schema reader itself, when it accepts the file, reads
+/// what the dom backend does
+///
+void check_same(const std::string& contents) {
+  const auto schema = parse_with(contents, sycl_info::parser_backend::schema);
+  const auto dom = parse_with(contents, sycl_info::parser_backend::dom);
+  const auto same = schema.parsed == dom.parsed && schema.impl == dom.impl &&
+                    schema.error == dom.error;
+  if (!same) {
+    std::printf("The backends differ on: %s\n", contents.c_str());
+  }
+  CHECK(same);
+
+  auto read = nlohmann::json{};
+  if (sycl_info::read_schema_file(contents.data(), contents.size(), read)) {
+    const auto read_same = dom.parsed && read == dom.impl;
+    if (!read_same) {
+      std::printf("The schema reader misread: %s\n", contents.c_str());
+    }
+    CHECK(read_same);
+  }
+}
+
+/// \brief A file whose name is the given json string, escaped as it is
+///
+std::string named(const std::string& escaped) {
+  return "{\"name\": \"" + escaped + "\", \"version\": \"1.0\"}";
+}
+
+/// \brief Whether the schema reader reads the file, without the dom backend
+///
+bool read_by_schema(const std::string& contents) {
+  auto impl = nlohmann::json{};
+  return sycl_info::read_schema_file(contents.data(), contents.size(), impl);
+}
+}  // namespace
+
+TEST_CASE("catalog_parser backends agree on escapes") {
+  for (const auto* escape :
+       {"\\\"", "\\\\", "\\/", "\\b", "\\f", "\\n", "\\r", "\\t"}) {
+    const auto contents = named(std::string{"a"} + escape + "b");
+    CHECK(read_by_schema(contents));
+    check_same(contents);
+  }
+  // \u escapes are left to the dom backend, as are unknown escapes
+  for (const auto* escape :
+       {"\\u0041", "\\u00e9", "\\ud83d\\ude00", "\\ud83d", "\\u12",
+        "\\x"}) {
+    const auto contents = named(std::string{"a"} + escape + "b");
+    CHECK_FALSE(read_by_schema(contents));
+    check_same(contents);
+  }
+}
+
+TEST_CASE("catalog_parser backends agree on non-ASCII and control bytes") {
+  for (const auto* text : {"caf\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80",
+                           "bad \xff byte", "cut \xc3", "\x01", "a\nb",
+                           "a\tb", "\x1f", "\x7f"}) {
+    check_same(named(text));
+  }
+}
+
+TEST_CASE("catalog_parser backends agree on specials at every offset") {
+  // 40 characters span two 16-character chunks and a tail, so each special
+  // is found by the vectorized loop at every offset of a chunk, then by the
+  // scalar loop
+  for (const auto* special :
+       {"\\\"", "\\\\", "\\n", "\\u0041", "\x01", "\x1f", "\xc3\xa9"}) {
+    for (std::size_t offset = 0; offset < 40; ++offset) {
+      auto text = std::string(40, 'x');
+      text.replace(offset, 1, special);
+      check_same(named(text));
+    }
+  }
+  for (const auto length : {15, 16, 17, 31, 32, 33, 64}) {
+    const auto contents = named(std::string(length, 'y'));
+    CHECK(read_by_schema(contents));
+    check_same(contents);
+  }
+}
+
+TEST_CASE("catalog_parser backends agree on keys and values") {
+  const auto config = std::string{
+      "\"platform_name\": \"P\", \"platform_vendor\": \"V\", "
+      "\"device_type\": \"GPU\", \"device_name\": \"D\", "
+      "\"device_vendor\": \"V\""};
+  for (const auto& contents : std::vector<std::string>{
+           // Unknown keys
+           "{\"name\": \"a\", \"extra\": \"b\"}",
+           "{\"supported_configurations\": [{" + config +
+               ", \"extra\": \"b\"}]}",
+           "{\"supported_configurations\": [{\"supported_backend_targets\": "
+           "[{\"backend_target\": \"SPIRV\", \"extra\": \"b\"}]}]}",
+           // Non-string values
+           "{\"name\": 1}",
+           "{\"name\": null}",
+           "{\"name\": [\"a\"]}",
+           "{\"supported_configurations\": {}}",
+           "{\"supported_configurations\": [\"a\"]}",
+           "{\"supported_configurations\": [{\"supported_drivers\": \"a\"}]}",
+           "{\"supported_configurations\": [{\"supported_drivers\": [1]}]}",
+           "{\"supported_configurations\": [{\"supported_backend_targets\": "
+           "[{\"device_flags\": true}]}]}",
+           // Duplicate keys
+           "{\"name\": \"a\", \"name\": \"b\"}",
+           "{\"supported_configurations\": [{" + config +
+               "}], \"supported_configurations\": []}",
+           "{\"supported_configurations\": [{" + config +
+               ", \"device_name\": \"E\"}]}",
+           // A whole file
+           "{\"name\": \"a\", \"vendor\": \"V\", \"version\": \"1.0\", "
+           "\"supported_configurations\": [{" +
+               config +
+               ", \"supported_drivers\": [\"1.0\", \"2.0\"], "
+               "\"supported_backend_targets\": [{\"backend_target\": "
+               "\"SPIRV\", \"device_flags\": \"-sycl-target spirv\"}]}]}",
+       }) {
+    check_same(contents);
+  }
+}
+
+TEST_CASE("catalog_parser backends agree on empty, trailing and truncated") {
+  for (const auto& contents : std::vector<std::string>{
+           "", " ", "{}", " {} \n", "[]", "\"a\"", "1", "null",
+           "{\"supported_configurations\": []}",
+           "{\"supported_configurations\": [{}]}",
+           "{\"supported_configurations\": [{\"supported_drivers\": [], "
+           "\"supported_backend_targets\": []}]}",
+           "{} x", "{}{}", "{\"name\": \"a\"} {\"name\": \"b\"}", "{},",
+           "{\"name\": \"a\",}", "{\"name\": \"a\" \"version\": \"b\"}",
+           "{\"supported_configurations\": [{},]}"}) {
+    check_same(contents);
+  }
+
+  const auto whole = sycl_info::test::syclinfo_file("Name", "1.0", "-flags");
+  CHECK(read_by_schema(whole));
+  for (std::size_t size = 0; size <= whole.size(); ++size) {
+    check_same(whole.substr(0, size));
+  }
+}
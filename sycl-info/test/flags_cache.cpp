@@ -0,0 +1,172 @@
+////////////////////////////////////////////////////////////////////////////////
+// flags_cache.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "flags_cache.hpp"
+
+#include "impl_finder.hpp"
+#include "test_utility.hpp"
+#include <doctest/doctest.h>
+#include <string>
+
+#ifdef __unix__
+using sycl_info::test::scoped_environment;
+using sycl_info::test::syclinfo_file;
+using sycl_info::test::temporary_directory;
+using sycl_info::test::write_file;
+
+namespace {
+/// \brief A cache directory, a catalog and OpenCL drivers of which the tests
+/// change one at a time
+///
+struct cache_fixture {
+  temporary_directory cache;
+  temporary_directory catalog;
+  temporary_directory icds;
+  scoped_environment cacheDirectory{"SYCL_INFO_CACHE_DIR",
+                                    cache.path().c_str()};
+  scoped_environment vendorPaths{"SYCL_VENDOR_PATHS", nullptr};
+  scoped_environment icdVendors{"OCL_ICD_VENDORS", icds.path().c_str()};
+  scoped_environment icdFilenames{"OCL_ICD_FILENAMES", nullptr};
+  sycl_info::flags_query query;
+
+  cache_fixture() {
+    write_file(catalog / "impl.syclinfo", syclinfo_file("Impl", "1.0", "-a"));
+    write_file(icds / "driver.icd", "libdriver.so\n");
+    query.impl = "Impl";
+    query.config = "1:1";
+    query.target = "SPIRV";
+    query.hint = catalog.path();
+  }
+
+  sycl_info::flags_cache_entry entry() const {
+    return sycl_info::flags_cache_entry{cache.path(), query};
+  }
+
+  /// \brief Stores flags for the query, then checks they are found
+  ///
+  void store() const {
+    entry().store(sycl_info::backend_info{"SPIRV", "-a -b"});
+    auto info = sycl_info::backend_info{};
+    REQUIRE(entry().lookup(info));
+    CHECK(info.backend == "SPIRV");
+    CHECK(info.deviceFlags == "-a -b");
+  }
+
+  bool found() const {
+    auto info = sycl_info::backend_info{};
+    return entry().lookup(info);
+  }
+
+  /// \brief The path of the only entry of the cache
+  ///
+  std::string entry_path() const {
+    for (const auto& name : sycl_info::list_directory(cache.path())) {
+      if (sycl_info::ends_with_suffix(name, ".flags")) {
+        return cache / name;
+      }
+    }
+    return std::string{};
+  }
+};
+}  // namespace
+
+TEST_CASE("flags_cache finds the flags stored for the same query") {
+  cache_fixture fixture;
+  CHECK_FALSE(fixture.found());
+  fixture.store();
+}
+
+TEST_CASE("flags_cache keys entries by the query") {
+  cache_fixture fixture;
+  fixture.store();
+  for (const auto change : {0, 1, 2, 3}) {
+    auto query = fixture.query;
+    if (change == 0) {
+      query.impl = "1";
+    } else if (change == 1) {
+      query.config = "1:2";
+    } else if (change == 2) {
+      query.target = "PTX64";
+    } else {
+      query.all = true;
+    }
+    auto info = sycl_info::backend_info{};
+    CHECK_FALSE(
+        sycl_info::flags_cache_entry{fixture.cache.path(), query}.lookup(info));
+  }
+}
+
+TEST_CASE("flags_cache misses once a .syclinfo file changes") {
+  cache_fixture fixture;
+  fixture.store();
+  write_file(fixture.catalog / "impl.syclinfo",
+             syclinfo_file("Impl", "1.0", "-a -c"));
+  CHECK_FALSE(fixture.found());
+
+  fixture.store();
+  write_file(fixture.catalog / "other.syclinfo",
+             syclinfo_file("Other", "1.0", "-d"));
+  CHECK_FALSE(fixture.found());
+}
+
+TEST_CASE("flags_cache misses once an OpenCL driver changes") {
+  cache_fixture fixture;
+  fixture.store();
+  write_file(fixture.icds / "driver.icd", "libother-driver.so\n");
+  CHECK_FALSE(fixture.found());
+
+  fixture.store();
+  write_file(fixture.icds / "second.icd", "libdriver.so\n");
+  CHECK_FALSE(fixture.found());
+}
+
+TEST_CASE("flags_cache misses once the hardware snapshot changes") {
+  cache_fixture fixture;
+  const auto snapshot = fixture.cache / "hardware.snapshot";
+  write_file(snapshot, "first");
+  fixture.query.snapshot = snapshot;
+  fixture.store();
+  write_file(snapshot, "second snapshot");
+  CHECK_FALSE(fixture.found());
+}
+
+TEST_CASE("flags_cache ignores truncated and garbled entries") {
+  cache_fixture fixture;
+  fixture.store();
+  const auto path = fixture.entry_path();
+  REQUIRE(!path.empty());
+
+  const auto entry = std::string{"sycl-info-flags 1\n5 5\nSPIRV-a -b"};
+  write_file(path, entry);
+  CHECK(fixture.found());
+  for (std::size_t size = 0; size < entry.size(); ++size) {
+    write_file(path, entry.substr(0, size));
+    CHECK_FALSE(fixture.found());
+  }
+  for (const auto* garbled :
+       {"sycl-info-flags 1\n5 5\nSPIRV-a -bc",
+        "sycl-info-flagz 1\n5 5\nSPIRV-a -b",
+        "sycl-info-flags 2\n5 5\nSPIRV-a -b",
+        "sycl-info-flags 1\n5 x\nSPIRV-a -b",
+        "sycl-info-flags 1\n5 5 SPIRV-a -b", "\x01\x02\x03"}) {
+    write_file(path, garbled);
+    CHECK_FALSE(fixture.found());
+  }
+}
+#endif  // __unix__
@@ -0,0 +1,154 @@
+////////////////////////////////////////////////////////////////////////////////
+// fleet_inventory.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "fleet_inventory.hpp"
+
+#include "hardware_snapshot.hpp"
+#include "test_utility.hpp"
+#include <doctest/doctest.h>
+#include <nlohmann/json.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using sycl_info::using_target_matcher;
+
+namespace {
+/// \brief A platform with one device of the given type
+///
+using_target_matcher::print_type hardware(const std::string& platform,
+                                          const std::string& device,
+                                          const std::string& type) {
+  auto dev = using_target_matcher::device{};
+  dev.name = device;
+  dev.vendor = "Vendor";
+  dev.type = type;
+  auto plat = using_target_matcher::platform{};
+  plat.name = platform;
+  plat.vendor = "Vendor";
+  plat.devices.insert(dev);
+  return using_target_matcher::print_type{plat};
+}
+
+std::string snapshot(const using_target_matcher::print_type& hardware) {
+  std::ostringstream out;
+  sycl_info::write_snapshot(hardware, out);
+  return out.str();
+}
+
+sycl_info::fleet_node node(const std::string& file, const std::string& print,
+                           const using_target_matcher::print_type& hardware) {
+  return sycl_info::fleet_node{file, print, hardware};
+}
+}  // namespace
+
+TEST_CASE("group_device_sets merges the nodes with the same device set") {
+  const auto gpu = hardware("Platform", "Device", "GPU");
+  const auto cpu = hardware("Platform", "Device", "CPU");
+  CHECK(sycl_info::fingerprint(gpu) ==
+        sycl_info::fingerprint(hardware("Platform", "Device", "GPU")));
+  CHECK(sycl_info::fingerprint(gpu) != sycl_info::fingerprint(cpu));
+
+  const auto fleet = sycl_info::group_device_sets(
+      {node("a", sycl_info::fingerprint(cpu), cpu),
+       node("b", sycl_info::fingerprint(gpu), gpu),
+       node("c", sycl_info::fingerprint(gpu), gpu)});
+  CHECK(fleet.nodes == 3);
+  REQUIRE(fleet.deviceSets.size() == 2);
+  // The most common first
+  CHECK(fleet.deviceSets[0].fingerprint == sycl_info::fingerprint(gpu));
+  CHECK(fleet.deviceSets[0].nodes == std::vector<std::string>{"b", "c"});
+  CHECK(fleet.deviceSets[1].nodes == std::vector<std::string>{"a"});
+}
+
+TEST_CASE("group_device_sets keeps apart sets whose fingerprints collide") {
+  const auto gpu = hardware("Platform", "Device", "GPU");
+  const auto cpu = hardware("Platform", "Device", "CPU");
+  const auto other = hardware("Other", "Device", "GPU");
+  const auto fleet = sycl_info::group_device_sets(
+      {node("a", "collision", gpu), node("b", "collision", cpu),
+       node("c", "collision", other), node("d", "collision", cpu),
+       node("e", "collision", gpu), node("f", "collision", cpu)});
+  CHECK(fleet.nodes == 6);
+  REQUIRE(fleet.deviceSets.size() == 3);
+  CHECK(fleet.deviceSets[0].nodes == std::vector<std::string>{"b", "d", "f"});
+  CHECK(fleet.deviceSets[0].hardware == cpu);
+  CHECK(fleet.deviceSets[0].hardware.begin()->devices.begin()->type == "CPU");
+  CHECK(fleet.deviceSets[1].nodes == std::vector<std::string>{"a", "e"});
+  CHECK(fleet.deviceSets[1].hardware.begin()->devices.begin()->type == "GPU");
+  CHECK(fleet.deviceSets[2].nodes == std::vector<std::string>{"c"});
+  CHECK(fleet.deviceSets[2].hardware.begin()->name == "Other");
+}
+
+#ifdef __unix__
+TEST_CASE("load_fleet deduplicates snapshots and skips other files") {
+  sycl_info::test::temporary_directory directory;
+  const auto gpu = hardware("Platform", "Device", "GPU");
+  const auto cpu = hardware("Platform", "Device", "CPU");
+  sycl_info::test::write_file(directory / "node1", snapshot(gpu));
+  sycl_info::test::write_file(directory / "node2", snapshot(cpu));
+  sycl_info::test::write_file(directory / "node3", snapshot(gpu));
+  sycl_info::test::write_file(directory / "notes.txt", "not a snapshot");
+  sycl_info::test::write_file(directory / ".hidden", snapshot(cpu));
+
+  const auto fleet = sycl_info::load_fleet(directory.path());
+  CHECK(fleet.nodes == 3);
+  CHECK(fleet.skipped == std::vector<std::string>{"notes.txt"});
+  REQUIRE(fleet.deviceSets.size() == 2);
+  CHECK(fleet.deviceSets[0].nodes ==
+        std::vector<std::string>{"node1", "node3"});
+  CHECK(fleet.deviceSets[0].fingerprint == sycl_info::fingerprint(gpu));
+  CHECK(fleet.deviceSets[1].nodes == std::vector<std::string>{"node2"});
+}
+#endif  // __unix__
+
+TEST_CASE("match_fleet counts the devices and nodes each backend matches") {
+  const auto gpu = hardware("Platform", "Device", "GPU");
+  const auto cpu = hardware("Platform", "Device", "CPU");
+  const auto fleet = sycl_info::group_device_sets(
+      {node("a", sycl_info::fingerprint(gpu), gpu),
+       node("b", sycl_info::fingerprint(gpu), gpu),
+       node("c", sycl_info::fingerprint(cpu), cpu)});
+  const auto impls = std::vector<nlohmann::json>{
+      nlohmann::json::parse(
+          sycl_info::test::syclinfo_file("First", "1.0", "-a")),
+      nlohmann::json::parse(
+          sycl_info::test::syclinfo_file("Second", "1.0", "-b"))};
+
+  const auto coverage = sycl_info::match_fleet(fleet, impls);
+  REQUIRE(coverage.size() == 2);
+  for (std::size_t i = 0; i < coverage.size(); ++i) {
+    CHECK(coverage[i].impl == impls[i]["name"]);
+    CHECK(coverage[i].backend == "SPIRV");
+    // The implementations only support GPUs
+    CHECK(coverage[i].devices == std::vector<std::size_t>{1, 0});
+    CHECK(coverage[i].nodes == 2);
+  }
+
+  // As --using-target matches each device set
+  for (const auto& set : fleet.deviceSets) {
+    for (unsigned int index = 1; index <= impls.size(); ++index) {
+      CHECK(sycl_info::match_supported(
+                using_target_matcher::from_json(impls[index - 1]),
+                sycl_info::supported_device_types(impls[index - 1]),
+                &set.hardware) ==
+            sycl_info::match_picked_impl(index, impls, false, &set.hardware));
+    }
+  }
+}
@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////////////////////
+// impl_finder.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "impl_finder.hpp"
+
+#include "test_utility.hpp"
+#include <doctest/doctest.h>
+#include <string>
+#include <vector>
+
+#ifdef __unix__
+#include <sys/stat.h>
+#include <unistd.h>
+
+using sycl_info::test::scoped_environment;
+using sycl_info::test::syclinfo_file;
+using sycl_info::test::temporary_directory;
+using sycl_info::test::write_file;
+
+TEST_CASE("find_impl finds the first implementation listed with a name") {
+  // q2.syclinfo is listed first, but foo.syclinfo is parsed first, as its
+  // file name is the requested name
+  temporary_directory first;
+  temporary_directory second;
+  write_file(first / "q2.syclinfo", syclinfo_file("Foo", "1.0", "-v1"));
+  write_file(second / "foo.syclinfo", syclinfo_file("Foo", "2.0", "-v2"));
+  scoped_environment vendors{"SYCL_VENDOR_PATHS", first.path().c_str()};
+  scoped_environment shared{"SYCL_INFO_SHARED_CATALOG", nullptr};
+
+  const auto lookup = sycl_info::find_impl("Foo", second.path());
+  REQUIRE(lookup.found);
+  CHECK(lookup.index == 1);
+  CHECK(lookup.impl["version"] == "1.0");
+
+  const auto impls = sycl_info::get_impls(second.path());
+  REQUIRE(impls.size() == 2);
+  CHECK(sycl_info::find_impl_index("Foo", impls) == lookup.index);
+
+  const auto second_lookup = sycl_info::find_impl("2", second.path());
+  REQUIRE(second_lookup.found);
+  CHECK(second_lookup.impl["version"] == "2.0");
+}
+
+TEST_CASE("get_impls lists a file reached through several paths once") {
+  // The same directory through a symlink, and a copy of one of its files
+  temporary_directory root;
+  const auto real = root / "real";
+  const auto link = root / "link";
+  const auto copy = root / "copy";
+  const auto hint = root / "hint";
+  for (const auto& directory : {real, copy, hint}) {
+    REQUIRE(mkdir(directory.c_str(), 0700) == 0);
+  }
+  REQUIRE(symlink(real.c_str(), link.c_str()) == 0);
+  const auto a = syclinfo_file("A", "1.0", "-a");
+  write_file(real + "/a.syclinfo", a);
+  write_file(real + "/b.syclinfo", syclinfo_file("B", "1.0", "-b"));
+  write_file(copy + "/a.syclinfo", a);
+  write_file(hint + "/c.syclinfo", syclinfo_file("C", "1.0", "-c"));
+  const auto vendors = real + ';' + link + ';' + copy;
+  scoped_environment vendorPaths{"SYCL_VENDOR_PATHS", vendors.c_str()};
+  scoped_environment shared{"SYCL_INFO_SHARED_CATALOG", nullptr};
+
+  const auto impls = sycl_info::get_impls(hint);
+  REQUIRE(impls.size() == 3);
+  const auto indexA = sycl_info::find_impl_index("A", impls);
+  REQUIRE(indexA != 0);
+  CHECK(impls[indexA - 1]["source_paths"] ==
+        nlohmann::json(std::vector<std::string>{
+            real + "/a.syclinfo", link + "/a.syclinfo", copy + "/a.syclinfo"}));
+  const auto indexB = sycl_info::find_impl_index("B", impls);
+  REQUIRE(indexB != 0);
+  CHECK(impls[indexB - 1]["source_paths"] ==
+        nlohmann::json(std::vector<std::string>{real + "/b.syclinfo",
+                                                link + "/b.syclinfo"}));
+  CHECK(impls[2]["name"] == "C");
+
+  // Resolved alike by name and by index, without listing every file
+  for (unsigned int index = 1; index <= impls.size(); ++index) {
+    const auto byIndex = sycl_info::find_impl(std::to_string(index), hint);
+    REQUIRE(byIndex.found);
+    CHECK(byIndex.index == index);
+    CHECK(byIndex.impl == impls[index - 1]);
+    const auto byName = sycl_info::find_impl(
+        impls[index - 1]["name"].get<std::string>(), hint);
+    REQUIRE(byName.found);
+    CHECK(byName.index == index);
+    CHECK(byName.impl == impls[index - 1]);
+  }
+  CHECK_FALSE(sycl_info::find_impl("4", hint).found);
+
+  // The duplicates take no index: each file keeps the one it has without them
+  scoped_environment realOnly{"SYCL_VENDOR_PATHS", real.c_str()};
+  const auto distinct = sycl_info::get_impls(hint);
+  REQUIRE(distinct.size() == 3);
+  for (std::size_t i = 0; i < distinct.size(); ++i) {
+    CHECK(distinct[i]["name"] == impls[i]["name"]);
+  }
+}
+#endif  // __unix__
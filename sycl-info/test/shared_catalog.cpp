@@ -0,0 +1,211 @@
+////////////////////////////////////////////////////////////////////////////////
+// shared_catalog.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "shared_catalog.hpp"
+
+#include "impl_finder.hpp"
+#include "test_utility.hpp"
+#include <cstdint>
+#include <cstring>
+#include <doctest/doctest.h>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using sycl_info::test::scoped_environment;
+using sycl_info::test::syclinfo_file;
+using sycl_info::test::temporary_directory;
+using sycl_info::test::write_file;
+
+namespace {
+// The offsets of the fields of a segment that the tests change, as laid out
+// by shared_catalog.cpp: a 56-byte header, then 32 bytes per implementation
+constexpr std::size_t creator_offset = 32;
+constexpr std::size_t impls_offset = 48;
+constexpr std::size_t entries_offset = 56;
+constexpr std::size_t entry_size = 32;
+
+/// \brief The segment of a list of directories, which is named after a
+/// temporary directory so that it is unique, and removed when the test ends
+///
+struct segment_fixture {
+  temporary_directory directory;
+  std::vector<std::string> paths{directory.path()};
+  sycl_info::search_options options;
+  std::string name = sycl_info::shared_catalog_name(paths, options);
+
+  ~segment_fixture() { shm_unlink(name.c_str()); }
+
+  std::vector<nlohmann::json> impls() const {
+    return {nlohmann::json::parse(syclinfo_file("First", "1.0", "-a")),
+            nlohmann::json::parse(syclinfo_file("Second", "2.0", "-b"))};
+  }
+
+  void publish(const std::uint64_t fingerprint) const {
+    auto writer = sycl_info::shared_catalog_writer::claim(paths, options);
+    REQUIRE(writer);
+    writer->publish(fingerprint, impls());
+  }
+
+  bool exists() const {
+    const auto fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+      return false;
+    }
+    close(fd);
+    return true;
+  }
+
+  /// \brief Overwrites a 64-bit field of the segment, as a process that
+  /// wrote it wrongly or died while writing it would have left it
+  ///
+  void overwrite(const std::size_t offset, const std::uint64_t value) const {
+    // A published segment is read-only, even to its owner
+    auto fd = shm_open(name.c_str(), O_RDONLY, 0);
+    REQUIRE(fd >= 0);
+    fchmod(fd, S_IRUSR | S_IWUSR);
+    close(fd);
+    fd = shm_open(name.c_str(), O_RDWR, 0);
+    REQUIRE(fd >= 0);
+    struct stat info;
+    REQUIRE(fstat(fd, &info) == 0);
+    const auto size = static_cast<std::size_t>(info.st_size);
+    auto* mapped =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    REQUIRE(mapped != MAP_FAILED);
+    std::memcpy(static_cast<unsigned char*>(mapped) + offset, &value,
+                sizeof(value));
+    munmap(mapped, size);
+  }
+};
+
+/// \brief The id of a process that has exited
+///
+std::uint64_t dead_process() {
+  const auto child = fork();
+  if (child == 0) {
+    _exit(0);
+  }
+  waitpid(child, nullptr, 0);
+  return static_cast<std::uint64_t>(child);
+}
+}  // namespace
+
+TEST_CASE("shared_catalog attaches to a published catalog") {
+  segment_fixture fixture;
+  CHECK_FALSE(sycl_info::shared_catalog::attach(fixture.paths,
+                                                fixture.options, 1));
+  fixture.publish(1);
+  CHECK_FALSE(
+      sycl_info::shared_catalog_writer::claim(fixture.paths, fixture.options));
+
+  const auto shared =
+      sycl_info::shared_catalog::attach(fixture.paths, fixture.options, 1);
+  REQUIRE(shared);
+  REQUIRE(shared->size() == 2);
+  CHECK(shared->has_name(0, "First"));
+  CHECK_FALSE(shared->has_name(0, "Second"));
+  CHECK(shared->has_name(1, "Second"));
+  CHECK(shared->load(1) == fixture.impls()[1]);
+  CHECK(shared->load_all() == fixture.impls());
+}
+
+TEST_CASE("shared_catalog removes a segment with another fingerprint") {
+  segment_fixture fixture;
+  fixture.publish(1);
+  CHECK_FALSE(
+      sycl_info::shared_catalog::attach(fixture.paths, fixture.options, 2));
+  CHECK_FALSE(fixture.exists());
+
+  fixture.publish(2);
+  CHECK(sycl_info::shared_catalog::attach(fixture.paths, fixture.options, 2));
+}
+
+TEST_CASE("shared_catalog removes a segment its dead creator left unready") {
+  segment_fixture fixture;
+  auto writer =
+      sycl_info::shared_catalog_writer::claim(fixture.paths, fixture.options);
+  REQUIRE(writer);
+
+  // Still being published by a live process: kept
+  CHECK_FALSE(
+      sycl_info::shared_catalog::attach(fixture.paths, fixture.options, 1));
+  CHECK(fixture.exists());
+
+  fixture.overwrite(creator_offset, dead_process());
+  CHECK_FALSE(
+      sycl_info::shared_catalog::attach(fixture.paths, fixture.options, 1));
+  CHECK_FALSE(fixture.exists());
+}
+
+TEST_CASE("shared_catalog removes a segment with entries out of bounds") {
+  const auto huge = std::uint64_t{1} << 62;
+  // The name offset and size, and the offset and size of the encoding, of
+  // the last entry, then the number of implementations
+  for (const auto offset :
+       {entries_offset + entry_size, entries_offset + entry_size + 8,
+        entries_offset + entry_size + 16, entries_offset + entry_size + 24,
+        impls_offset}) {
+    segment_fixture fixture;
+    fixture.publish(1);
+    fixture.overwrite(offset, huge);
+    CHECK_FALSE(
+        sycl_info::shared_catalog::attach(fixture.paths, fixture.options, 1));
+    CHECK_FALSE(fixture.exists());
+  }
+}
+
+TEST_CASE("find_impl resolves --impl alike with and without sharing") {
+  temporary_directory first;
+  temporary_directory second;
+  write_file(first / "q2.syclinfo", syclinfo_file("Foo", "1.0", "-v1"));
+  write_file(second / "foo.syclinfo", syclinfo_file("Foo", "2.0", "-v2"));
+  write_file(second / "bar.syclinfo", syclinfo_file("Bar", "1.0", "-b"));
+  scoped_environment vendors{"SYCL_VENDOR_PATHS", first.path().c_str()};
+  const auto name = sycl_info::shared_catalog_name(
+      sycl_info::get_vendor_paths(second.path()),
+      sycl_info::get_search_options());
+
+  for (const auto* requested : {"Foo", "Bar", "1", "2", "3", "4", "Baz"}) {
+    auto unshared = sycl_info::impl_lookup{};
+    {
+      scoped_environment shared{"SYCL_INFO_SHARED_CATALOG", nullptr};
+      unshared = sycl_info::find_impl(requested, second.path());
+    }
+    scoped_environment shared{"SYCL_INFO_SHARED_CATALOG", "1"};
+    // Published by the first lookup, then attached to by the second
+    for (auto pass = 0; pass < 2; ++pass) {
+      const auto lookup = sycl_info::find_impl(requested, second.path());
+      CHECK(lookup.found == unshared.found);
+      CHECK(lookup.index == unshared.index);
+      CHECK(lookup.impl == unshared.impl);
+    }
+    CHECK(sycl_info::get_impls(second.path()).size() == 3);
+    CHECK(shm_unlink(name.c_str()) == 0);
+  }
+}
+#endif  // __unix__
@@ -0,0 +1,154 @@
+////////////////////////////////////////////////////////////////////////////////
+// target_planner.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include "target_planner.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <doctest/doctest.h>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+/// \brief Makes a set of a universe of size elements
+///
+sycl_info::cover_set make_set(const std::size_t size,
+                              const std::vector<std::size_t>& elements) {
+  auto set = sycl_info::cover_set((size + 63) / 64);
+  for (const auto element : elements) {
+    set[element / 64] |= std::uint64_t{1} << (element % 64);
+  }
+  return set;
+}
+
+/// \brief A problem whose smallest cover is {0, 1}, but where the largest
+/// set, 2, is the one picked first greedily, which then needs both 0 and 1
+///
+std::vector<sycl_info::cover_set> greedy_trap() {
+  return {make_set(6, {0, 1, 2}), make_set(6, {3, 4, 5}),
+          make_set(6, {0, 1, 3, 4})};
+}
+
+/// \brief A configuration of the implementation used by plan_targets()
+///
+nlohmann::json make_config(const std::string& device,
+                           const std::vector<nlohmann::json>& backends) {
+  return {{"platform_name", "Platform"},
+          {"platform_vendor", "Vendor"},
+          {"device_type", "GPU"},
+          {"device_name", device},
+          {"device_vendor", "Vendor"},
+          {"supported_drivers", nlohmann::json::array()},
+          {"supported_backend_targets", backends}};
+}
+
+nlohmann::json make_backend(const std::string& name,
+                            const std::string& flags) {
+  return {{"backend_target", name}, {"device_flags", flags}};
+}
+
+sycl_info::using_target_matcher::print_type make_matched(
+    const std::vector<std::string>& devices) {
+  auto plat = sycl_info::using_target_matcher::platform{"Platform", "Vendor",
+                                                        {}};
+  for (const auto& device : devices) {
+    plat.devices.insert(
+        sycl_info::using_target_matcher::device{device, "Vendor", {}, {}, {}});
+  }
+  return {plat};
+}
+}  // namespace
+
+TEST_CASE("solve_set_cover searches small problems exhaustively") {
+  auto exact = false;
+  const auto picked = sycl_info::solve_set_cover(greedy_trap(), 6, exact);
+  CHECK(exact);
+  CHECK(picked == std::vector<std::size_t>{0, 1});
+}
+
+TEST_CASE("solve_set_cover picks greedily above exact_cover_limit") {
+  auto sets = greedy_trap();
+  while (sets.size() <= sycl_info::exact_cover_limit) {
+    sets.push_back(make_set(6, {}));
+  }
+  auto exact = true;
+  const auto picked = sycl_info::solve_set_cover(sets, 6, exact);
+  CHECK_FALSE(exact);
+  CHECK(picked == std::vector<std::size_t>{0, 1, 2});
+}
+
+TEST_CASE("solve_set_cover ignores the elements no set contains") {
+  auto exact = false;
+  const auto picked = sycl_info::solve_set_cover(
+      {make_set(8, {0, 1}), make_set(8, {1}), make_set(8, {2})}, 8, exact);
+  CHECK(exact);
+  CHECK(picked == std::vector<std::size_t>{0, 2});
+
+  const auto none = sycl_info::solve_set_cover({make_set(8, {})}, 8, exact);
+  CHECK(exact);
+  CHECK(none.empty());
+}
+
+TEST_CASE("solve_set_cover covers universes of more than one word") {
+  auto exact = false;
+  const auto picked = sycl_info::solve_set_cover(
+      {make_set(130, {0, 64}), make_set(130, {1, 129}),
+       make_set(130, {0, 1, 64, 129})},
+      130, exact);
+  CHECK(exact);
+  CHECK(picked == std::vector<std::size_t>{2});
+}
+
+TEST_CASE("plan_targets combines the device flags without duplicates") {
+  const auto impl = nlohmann::json{
+      {"name", "Implementation"},
+      {"supported_configurations",
+       {make_config("A", {make_backend("SPIR", "-sycl -sycl-target=spir"),
+                          make_backend("PTX", "-sycl -sycl-target=ptx64")}),
+        make_config("B", {make_backend("PTX", "-sycl -sycl-target=ptx64")}),
+        make_config("C", {make_backend("SPIR", "-sycl -fast")})}}};
+
+  const auto plan =
+      sycl_info::plan_targets(make_matched({"A", "B", "C"}), impl);
+  CHECK(plan.exact);
+  REQUIRE(plan.targets.size() == 2);
+  CHECK(plan.targets[0].backend == "SPIR");
+  CHECK(plan.targets[0].deviceFlags == "-sycl -sycl-target=spir -fast");
+  CHECK(plan.targets[1].backend == "PTX");
+  CHECK(plan.targets[1].deviceFlags == "-sycl -sycl-target=ptx64");
+  CHECK(plan.deviceFlags ==
+        "-sycl -sycl-target=spir -fast -sycl-target=ptx64");
+  CHECK(plan.uncovered.empty());
+}
+
+TEST_CASE("plan_targets lists the devices no backend supports") {
+  const auto impl = nlohmann::json{
+      {"name", "Implementation"},
+      {"supported_configurations",
+       {make_config("A", {make_backend("SPIR", "-sycl")}),
+        make_config("B", {})}}};
+
+  const auto plan = sycl_info::plan_targets(make_matched({"A", "B"}), impl);
+  REQUIRE(plan.targets.size() == 1);
+  CHECK(plan.targets[0].backend == "SPIR");
+  REQUIRE(plan.uncovered.size() == 1);
+  CHECK(plan.uncovered[0].device == "B");
+}
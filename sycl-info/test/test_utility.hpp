@@ -0,0 +1,141 @@
+////////////////////////////////////////////////////////////////////////////////
+// test_utility.hpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SYCL_INFO_TEST_UTILITY_HPP
+#define SYCL_INFO_TEST_UTILITY_HPP
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef __unix__
+#include <ftw.h>
+#include <unistd.h>
+#endif
+
+namespace sycl_info {
+namespace test {
+
+#ifdef __unix__
+/// \brief A directory created for a test, removed with its contents when the
+/// test ends
+///
+class temporary_directory {
+ public:
+  temporary_directory() {
+    const auto* tmpdir = std::getenv("TMPDIR");
+    path_ = std::string{(tmpdir && *tmpdir) ? tmpdir : "/tmp"} +
+            "/sycl-info-test-XXXXXX";
+    if (!mkdtemp(&path_[0])) {
+      throw std::runtime_error{"Cannot create a directory in " + path_};
+    }
+  }
+
+  temporary_directory(const temporary_directory&) = delete;
+  temporary_directory& operator=(const temporary_directory&) = delete;
+
+  ~temporary_directory() {
+    nftw(
+        path_.c_str(),
+        [](const char* path, const struct stat*, int, struct FTW*) {
+          return std::remove(path);
+        },
+        16, FTW_DEPTH | FTW_PHYS);
+  }
+
+  const std::string& path() const noexcept { return path_; }
+
+  /// \brief The path of an entry of the directory
+  ///
+  std::string operator/(const std::string& name) const {
+    return path_ + '/' + name;
+  }
+
+ private:
+  std::string path_;
+};
+
+/// \brief Sets an environment variable, or unsets it when value is null, and
+/// restores it when the test ends
+///
+class scoped_environment {
+ public:
+  scoped_environment(std::string name, const char* value)
+      : name_(std::move(name)) {
+    const auto* old = std::getenv(name_.c_str());
+    hadValue_ = old != nullptr;
+    if (hadValue_) {
+      oldValue_ = old;
+    }
+    set(value);
+  }
+
+  scoped_environment(const scoped_environment&) = delete;
+  scoped_environment& operator=(const scoped_environment&) = delete;
+
+  ~scoped_environment() { set(hadValue_ ? oldValue_.c_str() : nullptr); }
+
+ private:
+  void set(const char* value) {
+    if (value) {
+      setenv(name_.c_str(), value, 1);
+    } else {
+      unsetenv(name_.c_str());
+    }
+  }
+
+  std::string name_;
+  bool hadValue_;
+  std::string oldValue_;
+};
+#endif  // __unix__
+
+/// \brief Writes a file, replacing it if it exists
+///
+inline void write_file(const std::string& path, const std::string& contents) {
+  std::ofstream file{path, std::ios::binary | std::ios::trunc};
+  file << contents;
+  if (!file.flush()) {
+    throw std::runtime_error{"Cannot write " + path};
+  }
+}
+
+/// \brief The contents of a .syclinfo file with one configuration, whose
+/// device flags tell it apart from others with the same name
+///
+inline std::string syclinfo_file(const std::string& name,
+                                 const std::string& version,
+                                 const std::string& flags) {
+  return "{\"name\": \"" + name + "\", \"vendor\": \"Vendor\", " +
+         "\"version\": \"" + version + "\", " +
+         "\"supported_configurations\": [{" +
+         "\"platform_name\": \"Platform\", \"platform_vendor\": \"Vendor\", " +
+         "\"device_type\": \"GPU\", \"device_name\": \"Device\", " +
+         "\"device_vendor\": \"Vendor\", \"supported_drivers\": [], " +
+         "\"supported_backend_targets\": [{\"backend_target\": \"SPIRV\", " +
+         "\"device_flags\": \"" + flags + "\"}]}]}";
+}
+
+}  // namespace test
+}  // namespace sycl_info
+
+#endif  // SYCL_INFO_TEST_UTILITY_HPP
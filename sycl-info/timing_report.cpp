@@ -0,0 +1,151 @@
+////////////////////////////////////////////////////////////////////////////////
+// timing_report.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "timing_report.hpp"
+
+#include "record_writer.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <string>
+
+namespace sycl_info {
+
+namespace {
+struct phase_summary {
+  std::string phase;
+  std::size_t calls;
+  std::int64_t total;
+  std::int64_t self;
+};
+}  // namespace
+
+/// @brief Sums up the events of each phase. The time of an event is
+/// subtracted from the self time of the innermost event containing it on
+/// the same thread.
+///
+static std::vector<phase_summary> summarize(
+    std::vector<target_selector::trace_event> events) {
+  // Outer events first: by thread, start, then longest first
+  std::sort(events.begin(), events.end(),
+            [](const target_selector::trace_event& lhs,
+               const target_selector::trace_event& rhs) {
+              if (lhs.thread != rhs.thread) {
+                return lhs.thread < rhs.thread;
+              }
+              if (lhs.start != rhs.start) {
+                return lhs.start < rhs.start;
+              }
+              return lhs.duration > rhs.duration;
+            });
+
+  auto summaries = std::vector<phase_summary>{};
+  auto find_summary = [&summaries](const std::string& phase) -> std::size_t {
+    for (std::size_t i = 0; i < summaries.size(); ++i) {
+      if (summaries[i].phase == phase) {
+        return i;
+      }
+    }
+    summaries.push_back(phase_summary{phase, 0, 0, 0});
+    return summaries.size() - 1;
+  };
+
+  // The enclosing events, as (index of their summary, end)
+  auto open = std::vector<std::pair<std::size_t, std::int64_t>>{};
+  auto thread = events.empty() ? 0u : events.front().thread;
+  for (const auto& event : events) {
+    if (event.thread != thread) {
+      open.clear();
+      thread = event.thread;
+    }
+    while (!open.empty() && open.back().second <= event.start) {
+      open.pop_back();
+    }
+    const auto end = event.start + event.duration;
+    if (!open.empty() && end <= open.back().second) {
+      summaries[open.back().first].self -= event.duration;
+    }
+
+    const auto index = find_summary(event.phase);
+    ++summaries[index].calls;
+    summaries[index].total += event.duration;
+    summaries[index].self += event.duration;
+    open.emplace_back(index, end);
+  }
+
+  std::stable_sort(summaries.begin(), summaries.end(),
+                   [](const phase_summary& lhs, const phase_summary& rhs) {
+                     return lhs.self > rhs.self;
+                   });
+  return summaries;
+}
+
+void write_timings(const std::vector<target_selector::trace_event>& events,
+                   std::ostream& out) {
+  const auto milliseconds = [](std::int64_t microseconds) {
+    return static_cast<double>(microseconds) / 1000.0;
+  };
+
+  out << std::left << std::setw(20) << "Phase" << std::right << std::setw(8)
+      << "Calls" << std::setw(14) << "Total (ms)" << std::setw(14)
+      << "Self (ms)" << '\n';
+  out << std::fixed << std::setprecision(3);
+  for (const auto& summary : summarize(events)) {
+    out << std::left << std::setw(20) << summary.phase << std::right
+        << std::setw(8) << summary.calls << std::setw(14)
+        << milliseconds(summary.total) << std::setw(14)
+        << milliseconds(summary.self) << '\n';
+  }
+  out << std::defaultfloat;
+}
+
+void write_chrome_trace(
+    const std::vector<target_selector::trace_event>& events,
+    std::ostream& out) {
+  constexpr std::size_t processId = 1;
+
+  auto writer = json_writer{out};
+  writer.begin_object().key("traceEvents").begin_array();
+  for (const auto& event : events) {
+    // Complete events ("X"), with times in microseconds
+    writer.begin_object()
+        .key("name")
+        .value(std::string{event.phase})
+        .key("cat")
+        .value(std::string{"sycl-info"})
+        .key("ph")
+        .value(std::string{"X"})
+        .key("ts")
+        .value(static_cast<std::size_t>(event.start))
+        .key("dur")
+        .value(static_cast<std::size_t>(event.duration))
+        .key("pid")
+        .value(processId)
+        .key("tid")
+        .value(static_cast<std::size_t>(event.thread))
+        .end_object();
+  }
+  writer.end_array()
+      .key("displayTimeUnit")
+      .value(std::string{"ms"})
+      .end_object()
+      .end_document();
+}
+
+}  // namespace sycl_info
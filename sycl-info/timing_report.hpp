@@ -0,0 +1,47 @@
+////////////////////////////////////////////////////////////////////////////////
+// timing_report.hpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SYCL_INFO_TIMING_REPORT_HPP
+#define SYCL_INFO_TIMING_REPORT_HPP
+
+#include <ostream>
+#include <target_selector/scoped_timer.hpp>
+#include <vector>
+
+namespace sycl_info {
+
+/// @brief Writes how many times each phase ran and the time spent in it, both
+/// in total and in the phase itself rather than in the phases it contains
+/// (e.g. a match that enumerates the devices), for --timings
+/// @param The events recorded by target_selector::scoped_timer and a stream
+///
+void write_timings(const std::vector<target_selector::trace_event>& events,
+                   std::ostream& out);
+
+/// @brief Writes the events as a Chrome trace event file, for --trace, which
+/// can be opened with chrome://tracing or Perfetto
+/// @param The events recorded by target_selector::scoped_timer and a stream
+///
+void write_chrome_trace(
+    const std::vector<target_selector::trace_event>& events,
+    std::ostream& out);
+
+}  // namespace sycl_info
+
+#endif  // SYCL_INFO_TIMING_REPORT_HPP
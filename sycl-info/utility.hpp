@@ -18,6 +18,15 @@
 
 #include "config.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
 /// \brief Makes it possible to have auto-return types in C++11.
 /// \note This macro takes a single expression: it cannot take statements. If
 ///       you need to have multiple statements, you will need to use an
@@ -27,4 +36,78 @@
 #define SYCL_INFO_NOEXCEPT_RETURN_DECLTYPE_AUTO(...) \
   noexcept(noexcept(__VA_ARGS__))->decltype(__VA_ARGS__) { return __VA_ARGS__; }
 
+namespace sycl_info {
+/// \brief Incrementally computes the 64-bit FNV-1a hash of a sequence of
+///        bytes. It is used to fingerprint data, not for security.
+///
+class fnv1a_hash {
+ public:
+  /// \brief Adds a sequence of bytes to the hash.
+  ///
+  void update(const char* data, std::size_t size) noexcept {
+    for (std::size_t i = 0; i < size; ++i) {
+      state_ ^= static_cast<unsigned char>(data[i]);
+      state_ *= prime;
+    }
+  }
+
+  /// \brief Adds a string, followed by a terminator so that consecutive
+  ///        strings cannot be confused with their concatenation.
+  ///
+  void update(const std::string& str) noexcept {
+    update(str.data(), str.size() + 1);
+  }
+
+  /// \brief Returns the hash of the bytes added so far.
+  ///
+  SYCL_INFO_NODISCARD std::uint64_t value() const noexcept { return state_; }
+
+  /// \brief Returns the hash of the bytes added so far as 16 hex digits.
+  ///
+  SYCL_INFO_NODISCARD std::string hex() const {
+    constexpr const char* digits = "0123456789abcdef";
+    auto result = std::string(16, '0');
+    auto state = state_;
+    for (auto it = result.rbegin(); it != result.rend(); ++it, state >>= 4) {
+      *it = digits[state & 0xf];
+    }
+    return result;
+  }
+
+ private:
+  static constexpr std::uint64_t prime = 1099511628211ULL;
+  std::uint64_t state_ = 14695981039346656037ULL;
+};
+
+/// \brief Calls body(i) for every i in [0, count), spreading the calls over
+///        at most `workers` threads, the calling thread included. By default
+///        there are as many threads as the machine has cores. body must not
+///        throw.
+///
+inline void parallel_for(const std::size_t count,
+                         const std::function<void(std::size_t)>& body,
+                         std::size_t workers = 0) {
+  if (workers == 0) {
+    workers = std::max(1u, std::thread::hardware_concurrency());
+  }
+  workers = std::min(count, workers);
+
+  std::atomic<std::size_t> next{0};
+  auto work = [&]() {
+    for (auto i = next++; i < count; i = next++) {
+      body(i);
+    }
+  };
+
+  auto threads = std::vector<std::thread>{};
+  for (std::size_t i = 1; i < workers; ++i) {
+    threads.emplace_back(work);
+  }
+  work();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+}  // namespace sycl_info
+
 #endif  // SYCL_INFO_UTILITY_HPP
@@ -0,0 +1,97 @@
+////////////////////////////////////////////////////////////////////////////////
+// scoped_timer.hpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TARGET_SELECTOR_SCOPED_TIMER_HPP
+#define TARGET_SELECTOR_SCOPED_TIMER_HPP
+
+#include "target_selector/config.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace target_selector {
+
+/**
+  @brief A phase that was timed while tracing was enabled. Times are in
+  microseconds since tracing was enabled.
+*/
+struct trace_event {
+  const char* phase;
+  std::int64_t start;
+  std::int64_t duration;
+  /** @brief Identifies the thread the phase ran on, from 0 */
+  unsigned int thread;
+};
+
+/**
+  @brief Starts (or stops) recording the phases timed by scoped_timer. Until
+  it is called, a scoped_timer costs a single check.
+*/
+TARGET_SELECTOR_EXPORT void enable_tracing(bool enabled);
+
+/**
+  @brief Returns whether the phases timed by scoped_timer are recorded
+*/
+TARGET_SELECTOR_EXPORT bool tracing_enabled() noexcept;
+
+/**
+  @brief Returns the phases recorded so far, in the order they ended
+*/
+TARGET_SELECTOR_EXPORT std::vector<trace_event> trace_events();
+
+/**
+  @brief Records a phase that ran from start to end. The event is dropped if
+  it cannot be stored.
+*/
+TARGET_SELECTOR_EXPORT void record_trace_event(
+    const char* phase, std::chrono::steady_clock::time_point start,
+    std::chrono::steady_clock::time_point end) noexcept;
+
+/**
+  @brief Times the scope it is declared in as the given phase, when tracing
+  is enabled. The phase must be a string literal, or otherwise outlive the
+  recorded events.
+*/
+class scoped_timer {
+ public:
+  explicit scoped_timer(const char* phase) noexcept
+      : phase_(tracing_enabled() ? phase : nullptr) {
+    if (phase_) {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~scoped_timer() {
+    if (phase_) {
+      record_trace_event(phase_, start_, std::chrono::steady_clock::now());
+    }
+  }
+
+  scoped_timer(const scoped_timer&) = delete;
+  scoped_timer& operator=(const scoped_timer&) = delete;
+
+ private:
+  const char* phase_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace target_selector
+
+#endif  // TARGET_SELECTOR_SCOPED_TIMER_HPP
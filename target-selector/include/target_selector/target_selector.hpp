@@ -23,7 +23,9 @@
 #include "target_selector/config.hpp"
 
 #include "color_scope.hpp"
+#include "scoped_timer.hpp"
 #include <CL/opencl.h>
+#include <functional>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -102,6 +104,63 @@ TARGET_SELECTOR_EXPORT void find_devices(
     const std::unordered_map<std::string, std::string>& platforms,
     bool all = false);
 
+/** device_visitor.
+ * @brief Callback invoked by visit_devices for every (platform_id, device_id)
+ * pair that is found. Returning false cancels the enumeration.
+ */
+using device_visitor = std::function<bool(cl_platform_id, cl_device_id)>;
+
+/** visit_devices.
+ *  @brief Streaming counterpart of find_devices. Instead of collecting the
+ *  matching devices into a vector, each one is handed to the visitor as soon
+ *  as it is found, so the caller can process it straight away and stop the
+ *  enumeration early.
+ * @param visitor Callback invoked for each device found. Returning false stops
+ *  the enumeration without querying any further platforms or devices.
+ * @param reqVendor Required name of the vendor to pick devices from
+ * @param reqDeviceType Required type of device to select
+ * @param usedVendorAsType Set to true if reqVendor was used for the device
+ *  type
+ * @param platforms, the platforms to search for
+ * @param all Whether all device should be searched, including non-SPIR ones
+ * @return false if the visitor cancelled the enumeration, true otherwise
+ */
+TARGET_SELECTOR_EXPORT bool visit_devices(
+    const device_visitor& visitor, const std::string& reqVendor,
+    const std::string& reqDeviceType, bool& usedVendorAsType,
+    const std::unordered_map<std::string, std::string>& platforms,
+    bool all = false);
+
+/** platform_filter.
+ * @brief Callback that decides, given the name of a platform as returned by
+ * get_platform_name, which device types should be queried on it. Returning 0
+ * skips the platform without querying any of its devices.
+ */
+using platform_filter = std::function<cl_device_type(const std::string&)>;
+
+/** visit_devices.
+ *  @brief Overload of visit_devices that lets the caller choose the platforms
+ *  and device types to enumerate, so that unwanted platforms are skipped
+ *  before any of their devices are queried.
+ * @param visitor Callback invoked for each device found. Returning false stops
+ *  the enumeration without querying any further platforms or devices.
+ * @param filter Callback returning the device types to query for a platform
+ * @param all Whether all device should be searched, including non-SPIR ones
+ * @return false if the visitor cancelled the enumeration, true otherwise
+ */
+TARGET_SELECTOR_EXPORT bool visit_devices(const device_visitor& visitor,
+                                          const platform_filter& filter,
+                                          bool all = false);
+
+/** match_device_type.
+ * @brief Converts a device type name (cpu, gpu, accel) to its OpenCL value.
+ * The comparison is case insensitive.
+ * @param requested The name of the device type
+ * @return CL_DEVICE_TYPE_ALL if requested is any target, the matching OpenCL
+ * device type, or 0 if the name is not a known device type
+ */
+TARGET_SELECTOR_EXPORT cl_device_type match_device_type(std::string requested);
+
 /*!
   @brief Checks whether the device supports SPIR.
   @param device The device to get the info from
@@ -110,7 +169,8 @@ TARGET_SELECTOR_EXPORT void find_devices(
 TARGET_SELECTOR_EXPORT bool has_spir(cl_device_id device) noexcept;
 
 /*
- *@brief Helper function boilerplate to generate a target_selector warning
+ *@brief Helper function boilerplate to generate a target_selector warning on
+ *stderr
  */
 TARGET_SELECTOR_EXPORT void target_selector_warning(const std::string& message);
 
@@ -180,6 +240,7 @@ TARGET_SELECTOR_EXPORT std::string trim_end(std::string str);
 template <typename IdType, typename InfoType, typename Function>
 std::string get_info_from_opencl(IdType id, InfoType attr,
                                  Function fun) noexcept {
+  scoped_timer timer{"clGet*Info"};
   size_t size = 0;
 
   auto result = target_selector_warn_on_cl_error(
@@ -201,5 +262,13 @@ std::string get_info_from_opencl(IdType id, InfoType attr,
   return trim_end(std::move(idString));
 }
 
+/*!
+  @brief Queries the name of a platform, with the trailing '\0' and space
+  trimmed, as it is printed and matched against the catalog
+  @param id: the platform to query
+  @return The name of the platform. The error string otherwise
+*/
+TARGET_SELECTOR_EXPORT std::string get_platform_name(cl_platform_id id);
+
 }  // namespace target_selector
 #endif  // UTIL_DEVICE_SELECTOR_H
@@ -0,0 +1,87 @@
+////////////////////////////////////////////////////////////////////////////////
+// scoped_timer.cpp
+//
+// Copyright (C) Codeplay Software Limited.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//   http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+////////////////////////////////////////////////////////////////////////////////
+#include "scoped_timer.hpp"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace target_selector {
+
+namespace {
+/**
+ * @brief The events recorded while tracing is enabled
+ */
+struct trace_log {
+  std::mutex mutex;
+  std::chrono::steady_clock::time_point epoch;
+  std::vector<trace_event> events;
+  std::unordered_map<std::thread::id, unsigned int> threads;
+};
+
+std::atomic<bool> enabled{false};
+
+trace_log& global_log() {
+  static trace_log instance;
+  return instance;
+}
+
+std::int64_t microseconds(std::chrono::steady_clock::duration duration) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(duration)
+      .count();
+}
+}  // namespace
+
+void enable_tracing(bool enable) {
+  if (enable && !enabled) {
+    std::lock_guard<std::mutex> lock{global_log().mutex};
+    global_log().epoch = std::chrono::steady_clock::now();
+  }
+  enabled = enable;
+}
+
+bool tracing_enabled() noexcept {
+  return enabled.load(std::memory_order_relaxed);
+}
+
+std::vector<trace_event> trace_events() {
+  std::lock_guard<std::mutex> lock{global_log().mutex};
+  return global_log().events;
+}
+
+void record_trace_event(const char* phase,
+                        std::chrono::steady_clock::time_point start,
+                        std::chrono::steady_clock::time_point end) noexcept {
+  auto& traceLog = global_log();
+  try {
+    std::lock_guard<std::mutex> lock{traceLog.mutex};
+    const auto thread = traceLog.threads
+                            .emplace(std::this_thread::get_id(),
+                                     static_cast<unsigned int>(
+                                         traceLog.threads.size()))
+                            .first->second;
+    traceLog.events.push_back(trace_event{
+        phase, microseconds(start - traceLog.epoch),
+        microseconds(end - start), thread});
+  } catch (...) {
+    // Timing is best effort: it must not fail what is being timed
+  }
+}
+
+}  // namespace target_selector
@@ -156,53 +156,18 @@ void find_devices(
     const std::string& reqVendor, const std::string& reqDeviceType,
     bool& usedVendorAsType,
     const std::unordered_map<std::string, std::string>& platforms, bool all) {
-  ::cl_uint num_platforms = 0;
-
-  target_selector_warn_on_cl_error(
-      [&num_platforms]() {
-        return clGetPlatformIDs(0, nullptr, &num_platforms);
-      },
-      "Unable to retrieve number of platforms.");
-
-  if (num_platforms == 0) {
-    // The ICD loader could not find any platforms
-    return;
-  }
-
-  auto targetPlatforms = std::vector<cl_platform_id>(num_platforms);
-  target_selector_warn_on_cl_error(
-      [&num_platforms, &targetPlatforms]() {
-        return clGetPlatformIDs(num_platforms, targetPlatforms.data(), nullptr);
+  visit_devices(
+      [&devicesFound](cl_platform_id platform, cl_device_id device) {
+        devicesFound.emplace_back(platform, device);
+        return true;
       },
-      "Unable to retrieve platforms.");
-
-  auto get_platform_name = [](cl_platform_id platform) {
-    size_t len = 0;
-
-    auto result = target_selector_warn_on_cl_error(
-        [&platform, &len]() {
-          return clGetPlatformInfo(platform, CL_PLATFORM_NAME, 0, nullptr,
-                                   &len);
-        },
-        "Unable to retrieve size of platform name");
-    if (result != CL_SUCCESS) {
-      return std::string{"N/A"};
-    }
-
-    auto platformName = std::string(len, '\0');
-    result = target_selector_warn_on_cl_error(
-        [&platform, &platformName, &len]() {
-          return clGetPlatformInfo(platform, CL_PLATFORM_NAME, len,
-                                   &platformName[0], nullptr);
-        },
-        "Unable to retrieve platform name");
-    if (result != CL_SUCCESS) {
-      return std::string{"N/A"};
-    }
-
-    return platformName;
-  };
+      reqVendor, reqDeviceType, usedVendorAsType, platforms, all);
+}
 
+bool visit_devices(
+    const device_visitor& visitor, const std::string& reqVendor,
+    const std::string& reqDeviceType, bool& usedVendorAsType,
+    const std::unordered_map<std::string, std::string>& platforms, bool all) {
   auto get_device_type = [&platforms, &usedVendorAsType](
                              const std::string& reqVendor,
                              const std::string& reqDeviceType,
@@ -241,12 +206,44 @@ void find_devices(
     return deviceType;
   };
 
+  return visit_devices(
+      visitor,
+      [&](const std::string& platformName) {
+        return get_device_type(reqVendor, reqDeviceType, platformName);
+      },
+      all);
+}
+
+bool visit_devices(const device_visitor& visitor,
+                   const platform_filter& filter, bool all) {
+  ::cl_uint num_platforms = 0;
+
+  target_selector_warn_on_cl_error(
+      [&num_platforms]() {
+        // The first call loads the ICDs
+        scoped_timer timer{"clGetPlatformIDs"};
+        return clGetPlatformIDs(0, nullptr, &num_platforms);
+      },
+      "Unable to retrieve number of platforms.");
+
+  if (num_platforms == 0) {
+    // The ICD loader could not find any platforms
+    return true;
+  }
+
+  auto targetPlatforms = std::vector<cl_platform_id>(num_platforms);
+  target_selector_warn_on_cl_error(
+      [&num_platforms, &targetPlatforms]() {
+        scoped_timer timer{"clGetPlatformIDs"};
+        return clGetPlatformIDs(num_platforms, targetPlatforms.data(), nullptr);
+      },
+      "Unable to retrieve platforms.");
+
   for (auto platform : targetPlatforms) {
     const auto platformName = get_platform_name(platform);
 
     constexpr size_t skipCurrentIteration = 0;
-    const cl_device_type deviceType =
-        get_device_type(reqVendor, reqDeviceType, platformName);
+    const cl_device_type deviceType = filter(platformName);
     if (deviceType == skipCurrentIteration) {
       continue;
     }
@@ -254,36 +251,44 @@ void find_devices(
     ::cl_uint numDevices = 0;
     ::cl_int err = target_selector_warn_on_cl_error(
         [&platform, &deviceType, &numDevices]() {
-          return clGetDeviceIDs(platform, deviceType, 0, nullptr, &numDevices);
+          scoped_timer timer{"clGetDeviceIDs"};
+          const auto err =
+              clGetDeviceIDs(platform, deviceType, 0, nullptr, &numDevices);
+          // Filtering on a device type the platform does not have is expected
+          return (err == CL_DEVICE_NOT_FOUND) ? CL_SUCCESS : err;
         },
         std::string{": Unable to retrieve number of devices for platform " +
                     platformName});
 
-    if (err == CL_DEVICE_NOT_FOUND || err != CL_SUCCESS) {
+    if (err != CL_SUCCESS || numDevices == 0) {
       continue;
     }
 
     auto devices = std::vector<cl_device_id>(numDevices);
     target_selector_warn_on_cl_error(
         [&platform, deviceType, &numDevices, &devices]() {
+          scoped_timer timer{"clGetDeviceIDs"};
           return clGetDeviceIDs(platform, deviceType, numDevices,
                                 devices.data(), nullptr);
         },
         std::string{"could not find platform: " + platformName});
 
     for (const auto device : devices) {
-      if (all || has_spir(device)) {
-        devicesFound.emplace_back(platform, device);
+      if ((all || has_spir(device)) && !visitor(platform, device)) {
+        return false;
       }
     }
   }
+  return true;
 }
 
 void target_selector_warning(const std::string& message) {
+  // Warnings go to stderr, so that they neither interleave with nor corrupt
+  // the (buffered, possibly machine-readable) output on stdout
 #ifdef __linux__
-  color_scope cs(color_code::red, std::cout);
+  color_scope cs(color_code::red, std::cerr);
 #endif
-  std::cout << message << '\n';
+  std::cerr << message << '\n';
 }
 
 void target_selector_throw_error(const std::string& message) {
@@ -294,11 +299,18 @@ void target_selector_throw_error(const std::string& message) {
 }
 
 std::string trim_end(std::string str) {
-  if (str.back() == ' ' || str.back() == '\0') {
+  if (!str.empty() && (str.back() == ' ' || str.back() == '\0')) {
     str.pop_back();
   }
 
   return str;
 }
 
+std::string get_platform_name(cl_platform_id id) {
+  // get_info_from_opencl trims the '\0', and the second trim_end the space
+  // some drivers put before it
+  return trim_end(
+      get_info_from_opencl(id, CL_PLATFORM_NAME, clGetPlatformInfo));
+}
+
 }  // namespace target_selector